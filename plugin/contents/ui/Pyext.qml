@@ -37,27 +37,74 @@ Item {
         return '-';
     }
     
+    // in-process FileService from the plugin lib, null when not available
+    readonly property var native: {
+        if(!Common.checklib_wallpaper(root)) return null;
+        return Qt.createQmlObject(`
+            import com.github.catsout.wallpaperEngineKde 1.2
+            import QtQml 2.2
+            QtObject { readonly property var service: FileService }
+        `, root).service;
+    }
+    // in-process per wallpaper config, cached and written once changes settle
+    readonly property var config: {
+        if(!Common.checklib_wallpaper(root)) return null;
+        return Qt.createQmlObject(`
+            import com.github.catsout.wallpaperEngineKde 1.2
+            import QtQml 2.2
+            QtObject { readonly property var store: WallpaperConfig }
+        `, root).store;
+    }
+    function _nativeCall(method, args) {
+        return new Promise((resolve, reject) => {
+            root.native[method](...args, (error, result) => {
+                if(error) reject(error);
+                else resolve(result);
+            });
+        });
+    }
+
     function readfile(path) {
+        if(root.native) return root._nativeCall("readfile", [path]);
         return ws_server.jrpc.send("readfile", [path]).then((el) => {
             return Qt.atob(el.result);
         });
     }
+    // page cache hint for a wallpaper about to be shown, nothing without the plugin lib
+    function prefetch(path) {
+        if(root.native) return root._nativeCall("prefetch", [path]);
+        return Promise.resolve(0);
+    }
     function get_dir_size(path, depth=3) {
+        if(root.native) return root._nativeCall("get_dir_size", [path, depth]);
         return ws_server.jrpc.send("get_dir_size", [path, depth]).then(res => res.result);
     }
     function get_folder_list(path, opt={}) {
         return ws_server.jrpc.send("get_folder_list", [path, opt]).then(res => res.result);
     }
     function read_wallpaper_config(id) {
+        if(root.config) return Promise.resolve(root.config.read(id));
         return ws_server.jrpc.send("read_wallpaper_config", [id]).then(res => res.result);
     }
     function write_wallpaper_config(id, changed) {
+        if(root.config) return Promise.resolve(root.config.write(id, changed));
         return ws_server.jrpc.send("write_wallpaper_config", [id, changed]);
     }
+    // batch: { id: changed, ... }
+    function update_wallpaper_configs(batch) {
+        if(root.config) return Promise.resolve(root.config.update(batch));
+        return Promise.all(Object.entries(batch).map(([id, changed]) => root.write_wallpaper_config(id, changed)));
+    }
     function reset_wallpaper_config(id) {
+        if(root.config) return Promise.resolve(root.config.reset(id));
         return ws_server.jrpc.send("reset_wallpaper_config", [id]);
     }
     function delete_wallpaper(path, workshopid) {
+        if(root.native) {
+            // drop the cached options with the file
+            if(root.config && workshopid) root.config.reset(workshopid);
+            return root._nativeCall("delete_wallpaper", [path, workshopid || ""]);
+        }
         return ws_server.jrpc.send("delete_wallpaper", [path, workshopid || ""]).then(res => res.result);
     }
 
@@ -9,6 +9,8 @@ Item {
     property var workshopDirs
     property var globalConfigPath
     property string filterStr: ""
+    // words typed in the search field, each must prefix a word of the item
+    property string searchStr: ""
     property int sortMode: Common.SortMode.Id
     property bool enabled: true
 
@@ -20,7 +22,31 @@ Item {
     signal modelStartSync
     signal modelRefreshed
 
-    readonly property ListModel model: ListModel {
+    // native indexer, null when plugin lib is not available
+    property var library: {
+        if(!Common.checklib_wallpaper(root)) return null;
+        return Qt.createQmlObject(`
+            import com.github.catsout.wallpaperEngineKde 1.2
+            WallpaperLibrary { watch: true }
+        `, root);
+    }
+    // resolvers waiting for the next library scan
+    property var _libraryWaiting: []
+
+    // indexed filter and sort, null when plugin lib is not available
+    property var nativeModel: {
+        if(!Common.checklib_wallpaper(root)) return null;
+        return Qt.createQmlObject(`
+            import com.github.catsout.wallpaperEngineKde 1.2
+            WallpaperIndexModel {}
+        `, root);
+    }
+
+    // both have count, get(index) and assignModel(index, value)
+    readonly property var model: root.nativeModel ? root.nativeModel : listModel
+
+    ListModel {
+        id: listModel
         function assignModel(index, value) {
             Object.assign(this.get(index), value);
             const workshopid = this.get(index).workshopid;
@@ -127,20 +153,54 @@ Item {
             this.folderMapModel.forEach((value, key) => {
                 this.model.push(...value);
             });
+            if(root.nativeModel) {
+                root.modelStartSync();
+                this.syncNative();
+                root.nativeModel.setItems(this.model);
+                root.countNoFilter = this.model.length;
+                root.modelRefreshed();
+                return Promise.resolve();
+            }
             return filterToList(root.model, root.filterStr, this.model);
         }
-        function filterToList(listModel, filterStr, data) {
+        function genFilters(filterStr) {
             const filterValues = Common.filterModel.getValueArray(filterStr);
-            const filterstr = Common.filterModel.map((el, index) => {
+            return Common.filterModel.map((el, index) => {
                     return {
                         type: el.type,
                         key: el.key,
                         value: filterValues[index]
                     };
                 });
+        }
+        function genFilter(filterStr) {
+            const filter = Common.filterModel.genFilter(this.genFilters(filterStr));
+            const words = root.searchStr.toLowerCase().split(/\s+/).filter(el => el);
+            if(words.length === 0) return filter;
+            return (el) => {
+                if(!filter(el)) return false;
+                const text = [el.title, el.type, el.contentrating, el.workshopid]
+                    .concat(el.tags.map(t => t.key)).join(' ').toLowerCase();
+                return words.every(w => text.includes(w));
+            };
+        }
+        // filters and sort mode only, items are set by loadModel
+        function syncNative() {
+            const indexModel = root.nativeModel;
+            indexModel.setFilters(this.genFilters(root.filterStr));
+            indexModel.sortMode = root.sortMode;
+            indexModel.query = root.searchStr;
+        }
+        function filterToList(listModel, filterStr, data) {
             root.modelStartSync();
+            if(root.nativeModel) {
+                this.syncNative();
+                root.countNoFilter = this.model.length;
+                root.modelRefreshed();
+                return Promise.resolve();
+            }
             return new Promise((resolve, reject) => {
-                const filter = Common.filterModel.genFilter(filterstr);
+                const filter = this.genFilter(filterStr);
                 const model = listModel;
                 data.sort(genSortCmp(sortMode));
                 model.clear();
@@ -154,6 +214,52 @@ Item {
                 root.modelRefreshed();
             });
         }
+
+        // sorted position in listModel, listModel is kept sorted by filterToList
+        function _lowerBound(listModel, el, cmp) {
+            let lo = 0, hi = listModel.count;
+            while(lo < hi) {
+                const mid = (lo + hi) >> 1;
+                if(cmp(listModel.get(mid), el) < 0) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+        function _removeFromList(listModel, workshopid) {
+            for(let i=0;i<listModel.count;i++) {
+                if(listModel.get(i).workshopid === workshopid) {
+                    listModel.remove(i);
+                    return;
+                }
+            }
+        }
+        // row level update, only touch changed items
+        function applyDelta(added, changed, removed) {
+            const listModel = root.model;
+            const filter = this.genFilter(root.filterStr);
+            const cmp = genSortCmp(sortMode);
+            const drop = new Set(removed.concat(changed.map(el => el.workshopid)));
+            if(drop.size > 0) {
+                this.model = this.model.filter(el => !drop.has(el.workshopid));
+                this.folderMapModel.forEach((value, key) => {
+                    this.folderMapModel.set(key, value.filter(el => !drop.has(el.workshopid)));
+                });
+                if(!root.nativeModel)
+                    drop.forEach(id => this._removeFromList(listModel, id));
+            }
+            const list = this.folderMapModel.get(root.folder) || [];
+            added.concat(changed).forEach(el => {
+                this.model.push(el);
+                list.push(el);
+                if(!root.nativeModel && filter(el))
+                    listModel.insert(this._lowerBound(listModel, el, cmp), el);
+            });
+            this.folderMapModel.set(root.folder, list);
+            if(root.nativeModel)
+                root.nativeModel.applyDelta(added, changed, removed);
+            root.countNoFilter = this.model.length;
+            root.modelRefreshed();
+        }
     }
 
     function refresh() {
@@ -161,6 +267,8 @@ Item {
         const p_list = [];
 
         return loadPlaylists().then(() => {
+            if(root.library)
+                return root.refreshLibrary();
             this.workshopDirs.forEach(el => {
                 const dirs = (Array.isArray(el) ? el : [el]).map(Common.urlNative);
                 p_list.push(pyext.get_folder_list(
@@ -184,6 +292,58 @@ Item {
         });
     }
 
+    function refreshLibrary() {
+        return new Promise((resolve, reject) => {
+            root._libraryWaiting.push(resolve);
+            root.library.scan(root.workshopDirs);
+        });
+    }
+    function _toLibraryItem(item) {
+        const v = Object.assign({}, Common.wpitem_template, item);
+        root.applyPlaylists(v);
+        root._initItemOp(v);
+        return v;
+    }
+
+    // scans also come from the watcher when inotify overflowed
+    Connections {
+        target: root.library
+        ignoreUnknownSignals: true
+        function onScanned(items) {
+            const waiting = root._libraryWaiting;
+            root._libraryWaiting = [];
+            root.loadLibraryItems(items).then(() => waiting.forEach(resolve => resolve()));
+        }
+        function onItemsAdded(items) {
+            if(!root.enabled) return;
+            folderWorker.applyDelta(items.map(root._toLibraryItem), [], []);
+        }
+        function onItemsChanged(items) {
+            if(!root.enabled) return;
+            folderWorker.applyDelta([], items.map(root._toLibraryItem), []);
+        }
+        function onItemsRemoved(workshopids) {
+            if(!root.enabled) return;
+            folderWorker.applyDelta([], [], workshopids);
+        }
+    }
+
+    function applyPlaylists(el) {
+        el.playlists = [];
+        Object.keys(root.playlists).forEach((key) => {
+            const value = root.playlists[key];
+            if(value.has(el.path)) {
+                if(!el.playlists.includes(key))
+                    el.playlists.push(Object({key: key}));
+            }
+        });
+    }
+
+    // items are already parsed by WallpaperLibrary
+    function loadLibraryItems(items) {
+        return folderWorker.loadModel(root.folder, items.map(root._toLibraryItem));
+    }
+
     function loadFolderLists(folders) {
         const proxyModel = []
         folders.forEach(folder => {
@@ -206,15 +366,8 @@ Item {
             proxyModel.forEach((el) => {
                 // as no allSettled, catch any error
                 const p = root._readfile(Common.urlNative(Common.getWpModelProjectPath(el))).then(value => {                    
-                        el.playlists = [];
                         root.loadItemFromJson(value, el);
-                        Object.keys(root.playlists).forEach((key) => {
-                            const value = root.playlists[key];
-                            if(value.has(el.path)) {       
-                                if(!el.playlists.includes(key))
-                                    el.playlists.push(Object({key: key}));
-                            }
-                        });
+                        root.applyPlaylists(el);
                     }).catch(reason => console.error(reason));
                 plist.push(p);
             });
@@ -236,6 +389,16 @@ Item {
             return Promise.resolve();
         });
         this.sortModeChanged.connect(this.filterStrChanged);
+        // per keystroke, the native model only narrows its last matches
+        this.searchStrChanged.connect(function() {
+            if(!root.enabled) return Promise.resolve();
+            if(root.nativeModel) {
+                root.nativeModel.query = root.searchStr;
+                root.modelRefreshed();
+                return Promise.resolve();
+            }
+            return folderWorker.filterToList(root.model, root.filterStr, folderWorker.model);
+        });
         this.enabledChanged.connect(this.refresh.bind(this));
 
         const fc = this.readfile;
@@ -3,9 +3,9 @@ import QtQuick.Controls 2.0
 import QtQuick.Layouts 1.2
 import QtQuick.Window 2.1
 import org.kde.plasma.core 2.0 as PlasmaCore
-import org.kde.plasma.plasma5support as Plasma5Support
 
 import org.kde.taskmanager 0.1 as TaskManager
+import com.github.catsout.wallpaperEngineKde
 
 /*
 https://github.com/KDE/plasma-workspace/blob/master/libtaskmanager/abstracttasksmodel.h
@@ -59,7 +59,6 @@ https://github.com/KDE/plasma-workspace/blob/master/libtaskmanager/abstracttasks
 
 Item {
     id: wModel
-    property bool logging: false
     property var desktop: 0
 
     property string activity
@@ -68,10 +67,16 @@ Item {
     property alias filterByScreen: tasksModel.filterByScreen
     property alias resumeTime: playTimer.interval
     property int modePlay
+    // panels are not tasks, a maximized window still leaves them uncovered
+    property real coveredBelow: 0.05
+    property real reduceBelow: 0.25
 
     // ---
     readonly property bool reqPause: _reqPause
     property bool _reqPause: false
+    // mostly hidden, backends can drop to a lower frame rate
+    readonly property bool reqReduce: modePlay !== Common.PauseMode.Never
+        && occlusion.uncoveredFraction < reduceBelow
 
     Timer{
         id: playTimer
@@ -126,153 +131,44 @@ Item {
         // filterByScreen: true
 
         // demandingAttentionSkipsFilters not available here, which may cause, 
-        // skip activity filter, so filter activties manually
+        // skip activity filter, so occlusion filters activities itself
         //demandingAttentionSkipsFilters: false
         //activity: wModel.activity
         //filterByActivity: true
-
-        onActiveTaskChanged: updateWindowsinfo();
-        onVirtualDesktopChanged: {
-            if(wModel.logging)
-                console.error(this.virtualDesktop, ':', this.screenGeometry)
-            updateWindowsinfo();
-        }
-        function getProperty(idx, property) {
-            if(TaskManager.AbstractTasksModel[property] === undefined) return undefined;
-            return this.data(idx, TaskManager.AbstractTasksModel[property]);
-        }
-    }
-
-    Plasma5Support.SortFilterModel {
-        filterRole: 'IsWindow'
-        filterRegExp: 'true'
-        sourceModel: tasksModel
-        onDataChanged: updateWindowsinfo()
-        onCountChanged: updateWindowsinfo()
-    }
-
-    Timer{
-        id: triggerTimer
-        running: false
-        repeat: false
-        interval: 100
-        onTriggered: {
-            _updateWindowsinfo();
-        }
     }
 
-    /*
-    filters {
-        IsWindows: true
-    }
-    callback(getproperty) { return getproperty("IsWindows") === true }
-    */
-    function genTaskModelFilter(model) {
-        function doCallback(idx, callback) {
-            return callback((property) => model.getProperty(idx, property));
-        }
-        function filter(callback, inArray) {
-            const array = inArray ? inArray : Array.from(Array(model.count).keys());
-            return array.filter(el => {
-                const idx = model.makeModelIndex(el);
-                return doCallback(idx, callback);
-            });
-        }
-        return {
-            filter: function(filters, array) {
-                return filter((getProperty) => {
-                    const nfilters = filters ? filters : {};
-                    for(const [key, value] of Object.entries(nfilters)) {
-                        const property = getProperty(key);
-                        if(property !== undefined && property !== value)
-                            return false;
-                    };
-                    return true;
-                }, array);
-            },
-            filterCallback: function(callback, array) {
-                return filter(callback, array);
-            }
-        };
+    // follows the model rows, no walks over every task here
+    WindowOcclusion {
+        id: occlusion
+        model: tasksModel
+        screenGeometry: wModel.screenGeometry
+        activity: wModel.activity
+        onChanged: wModel.updateWindowsinfo()
     }
+    onModePlayChanged: updateWindowsinfo()
 
     function updateWindowsinfo() {
-        triggerTimer.start();
-    }
-    function _updateWindowsinfo() {
-        if(modePlay === Common.PauseMode.Never) {
-            playBy(true);
-            return;
-        }
-        const basefilters = {
-            IsWindow: true,
-//            SkipTaskbar: false,
-//            SkipPager: false
-        };
-        const taskFilter = genTaskModelFilter(tasksModel);
-        const baseWModel = taskFilter.filterCallback((getproperty) => {
-            const activities = getproperty("Activities");
-            if(activities && activities.length) {
-                for(let i=0;i < activities.length;i++) {
-                    if(activities[i] === wModel.activity)
-                        return true;
-                }
-                return false;
-            }
-            // true when model don't have activities info
-            return true;
-        }, taskFilter.filter(basefilters));
-        const notMinWModel = taskFilter.filter({IsMinimized: false}, baseWModel);
-
-        // can simply skip when "activity != currentActivity", but use full filter
-        //const notMinWModel = filterTaskModel(tasksModel, Object.assign({IsMinimized: false}, basefilters)).filter();
-        const maxWModel = taskFilter.filterCallback((getproperty) => {
-            return getproperty("IsMaximized") === true || getproperty("IsFullScreen") === true;
-        }, notMinWModel);
-
-        const fullSModel = taskFilter.filterCallback((getproperty) => {
-            return getproperty("IsFullScreen") === true;
-        }, notMinWModel);
-
-        const activeModel = taskFilter.filter({IsActive: true}, notMinWModel);
-
-
         switch (modePlay) {
         case Common.PauseMode.FocusOrMax:
-            playBy(maxWModel.length === 0 && activeModel.length === 0);
+            playBy(occlusion.maximizedCount === 0 && occlusion.activeCount === 0);
             break;
         case Common.PauseMode.Any:
-            playBy(notMinWModel.length === 0);
+            playBy(occlusion.windowCount === 0);
             break;
         case Common.PauseMode.Max:
-            playBy(maxWModel.length === 0);
+            playBy(occlusion.maximizedCount === 0);
             break;
         case Common.PauseMode.FullScreen:
-            console.log("fullScreen", fullSModel);
-            playBy(fullSModel.length === 0);
+            playBy(occlusion.fullScreenCount === 0);
             break;
         case Common.PauseMode.Focus:
-            playBy(activeModel.length === 0);
+            playBy(occlusion.activeCount === 0);
+            break;
+        case Common.PauseMode.Covered:
+            playBy(occlusion.uncoveredFraction >= coveredBelow);
             break;
         default:
             playBy(true);
         }
-
-        if(logging) {
-            const printW = (i) => {
-                const idx = tasksModel.makeModelIndex(i);
-                const name = tasksModel.data(idx, TaskManager.AbstractTasksModel.AppName);
-                const activity = tasksModel.data(idx, TaskManager.AbstractTasksModel.Activities);
-                console.error("--", name, activity);
-            }
-            console.error("--------Not Minimized--------");
-            notMinWModel.forEach(printW);
-            console.error("---------Maximized----------");
-            maxWModel.forEach(printW);
-            console.error("-----------Active-----------");
-            activeModel.forEach(printW);
-            console.error("\n\n\n")
-        }
     }
 }
-
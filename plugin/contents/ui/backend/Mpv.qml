@@ -9,30 +9,16 @@ Item{
     readonly property int displayMode: background.displayMode
     readonly property real videoRate: background.speed
     readonly property bool stats: background.mpvStats
+    // warm start, stay paused on the first frame until swapped in
+    property bool preloading: false
+    property bool ready: false
     property var volumeFade: Common.createVolumeFade(
         videoItem, 
         Qt.binding(function() { return background.mute ? 0 : background.volume; }),
         (volume) => { player.volume = volume; }
     )
-    
-    onDisplayModeChanged: {
-        if(videoItem.displayMode == Common.DisplayMode.Crop) {
-            player.setProperty("keepaspect", true);
-            player.setProperty("panscan", 1.0);
-        } else if(videoItem.displayMode == Common.DisplayMode.Aspect) {
-            player.setProperty("keepaspect", true);
-            player.setProperty("panscan", 0.0);
-        } else if(videoItem.displayMode == Common.DisplayMode.Scale) {
-            player.setProperty("keepaspect", false);
-            player.setProperty("panscan", 0.0);
-        }
-    }
-    // it's ok for toggle, true will always cause a signal at first
-    onStatsChanged: {
-        player.command(["script-binding","stats/display-stats-toggle"]);
-    }
 
-    onVideoRateChanged: player.setProperty('speed', videoRate);
+    onVideoRateChanged: player.setPropertyAsync('speed', videoRate);
 
     // logfile
     // source
@@ -44,16 +30,59 @@ Item{
         anchors.fill: parent
         mute: background.mute
         volume: 0
+        displayMode: videoItem.displayMode
+        // screens showing the same video share one decode
+        shared: true
+        stats: videoItem.stats
+        direct: background.mpvDirect
+        maxFps: governor.fps
+        renderScale: governor.renderScale
+        decodeDownscale: governor.decodeDownscale
+        transcodeDir: background.transcodeVideo ? Common.urlNative(pluginInfo.cache_path) + "/transcode" : ""
+        transcodeLimit: background.transcodeCacheSize
         Connections {
             ignoreUnknownSignals: true
             onFirstFrame: {
+                if(videoItem.startPos > 0) player.setPropertyAsync('start', 'none');
+                videoItem.ready = true;
+                if(videoItem.preloading) {
+                    player.pause();
+                    return;
+                }
                 background.sig_backendFirstFrame('mpv');
             }
+            onCoreFailed: {
+                // a preloaded one is dropped, the normal load then fails here too
+                if(backendLoader.item === videoItem)
+                    backendLoader.loadInfoShow("Could not create an mpv core, see the plasmashell log.");
+            }
         }
     }
+    QualityGovernor {
+        id: governor
+        target: player
+        active: background.adaptiveQuality
+        baseFps: background.reduced ? 24 : 0
+    }
+    PluginInfo {
+        id: pluginInfo
+    }
+    // QT_LOGGING_RULES="wekde.stats.debug=true" logs a json snapshot every interval
+    FrameStats {
+        target: player
+        active: videoItem.stats
+    }
+    // position to start from, set when reloaded after a deep pause
+    property real startPos: 0
+    onPreloadingChanged: if(!preloading) background.nowBackend = 'mpv';
     Component.onCompleted:{
-        background.nowBackend = 'mpv';
-        videoItem.displayModeChanged();
+        if(!preloading) background.nowBackend = 'mpv';
+        // start applies to the next load only, reset after it so loops start at 0
+        if(startPos > 0) player.setProperty('start', `+${startPos}`);
+    }
+    function saveState() {
+        const pos = player.getProperty('time-pos');
+        return { startPos: typeof pos === 'number' ? pos : 0 };
     }
 
     function play(){
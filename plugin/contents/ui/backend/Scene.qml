@@ -8,6 +8,9 @@ Item{
     property alias source: player.source
     property string assets: "assets"
     property int displayMode: background.displayMode
+    // warm start, stay paused on the first frame until swapped in
+    property bool preloading: false
+    property bool ready: false
     property var volumeFade: Common.createVolumeFade(
         sceneItem, 
         Qt.binding(function() { return background.mute ? 0 : background.volume; }),
@@ -26,8 +29,8 @@ Item{
     SceneViewer {
         id: player
         anchors.fill: parent
-        fps: background.fps
-        muted: background.mute
+        fps: governor.fps
+        muted: background.mute || sceneItem.preloading
         speed: background.speed
         assets: sceneItem.assets
         Component.onCompleted: {
@@ -38,13 +41,30 @@ Item{
         Connections {
             target: player
             function onFirstFrame() {
+                sceneItem.ready = true;
+                if(sceneItem.preloading) {
+                    player.pause();
+                    return;
+                }
                 background.sig_backendFirstFrame('scene');
             }
         }
     }
 
+    QualityGovernor {
+        id: governor
+        target: player
+        active: background.adaptiveQuality
+        baseFps: background.reduced ? Math.max(5, Math.round(background.fps / 2)) : background.fps
+    }
+    FrameStats {
+        target: player
+        active: background.mpvStats
+    }
+
+    onPreloadingChanged: if(!preloading) background.nowBackend = 'scene';
     Component.onCompleted: {
-        background.nowBackend = 'scene';
+        if(!preloading) background.nowBackend = 'scene';
         sceneItem.displayModeChanged();
     }
     function play() {
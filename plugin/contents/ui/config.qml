@@ -19,16 +19,24 @@ ColumnLayout {
     property alias  cfg_Fps:                 settingPage.cfg_Fps
     property alias  cfg_Volume:              settingPage.cfg_Volume
     property alias  cfg_MpvStats:            settingPage.cfg_MpvStats
+    property alias  cfg_MpvDirect:           settingPage.cfg_MpvDirect
+    property alias  cfg_TranscodeVideo:      settingPage.cfg_TranscodeVideo
+    property alias  cfg_TranscodeCacheSize:  settingPage.cfg_TranscodeCacheSize
     property alias  cfg_Speed:               settingPage.cfg_Speed
     property alias  cfg_MuteAudio:           settingPage.cfg_MuteAudio
     property alias  cfg_MouseInput:          settingPage.cfg_MouseInput
     property alias  cfg_ResumeTime:          settingPage.cfg_ResumeTime
+    property alias  cfg_DeepPauseAfter:      settingPage.cfg_DeepPauseAfter
     property alias  cfg_SwitchTimer:         settingPage.cfg_SwitchTimer
     property alias  cfg_RandomizeWallpaper:  settingPage.cfg_RandomizeWallpaper
     property alias  cfg_NoRandomWhilePaused: settingPage.cfg_NoRandomWhilePaused
     property alias  cfg_PauseFilterByScreen: settingPage.cfg_PauseFilterByScreen
     property alias  cfg_PauseOnBatPower:     settingPage.cfg_PauseOnBatPower
     property alias  cfg_PauseBatPercent:     settingPage.cfg_PauseBatPercent
+    property alias  cfg_ReduceOnBatPower:    settingPage.cfg_ReduceOnBatPower
+    property alias  cfg_ReduceOnPowerSaver:  settingPage.cfg_ReduceOnPowerSaver
+    property alias  cfg_AdaptiveQuality:     settingPage.cfg_AdaptiveQuality
+    property alias  cfg_UnloadAfter:         settingPage.cfg_UnloadAfter
     property int    cfg_DisplayMode
     property int    cfg_PauseMode
     property int    cfg_VideoBackend
@@ -87,6 +95,18 @@ ColumnLayout {
         }
     }
 
+    property var trace_recorder: {
+        if(!libcheck.wallpaper) {
+            trace_recorder = null
+        } else {
+            trace_recorder = Qt.createQmlObject(`
+                import QtQuick 2.0;
+                import com.github.catsout.wallpaperEngineKde 1.2
+                TraceRecorder {}
+            `, this);
+        }
+    }
+
     property var pyext: {
         if(!libcheck.qtwebsockets) {
             pyext = null
@@ -23,9 +23,17 @@ Rectangle {
     property bool   noRandomWhilePaused: wallpaper.configuration.NoRandomWhilePaused
     property bool   mouseInput: wallpaper.configuration.MouseInput
     property bool   mpvStats: wallpaper.configuration.MpvStats
+    property bool   mpvDirect: wallpaper.configuration.MpvDirect
+    property bool   transcodeVideo: wallpaper.configuration.TranscodeVideo
+    property int    transcodeCacheSize: wallpaper.configuration.TranscodeCacheSize
 
     property bool   pauseOnBatPower: wallpaper.configuration.PauseOnBatPower
+    property bool   reduceOnBatPower: wallpaper.configuration.ReduceOnBatPower
     property int    pauseBatPercent: wallpaper.configuration.PauseBatPercent
+    property bool   reduceOnPowerSaver: wallpaper.configuration.ReduceOnPowerSaver
+    property bool   adaptiveQuality: wallpaper.configuration.AdaptiveQuality
+    property int    unloadAfter: wallpaper.configuration.UnloadAfter
+    property int    deepPauseAfter: wallpaper.configuration.DeepPauseAfter
 
     
     property var curOpt: ({})
@@ -49,22 +57,64 @@ Rectangle {
     onPerOptChangedChanged: {
         pyext.read_wallpaper_config(workshopid).then((res) => this.curOpt = res);
     }
+    // the native store tells about saves directly, without the config round trip
+    Connections {
+        target: pyext.config
+        ignoreUnknownSignals: true
+        function onChanged(wid) {
+            if(wid === background.workshopid)
+                background.curOpt = pyext.config.read(wid);
+        }
+    }
 
     // auto pause
-    property bool   ok: !windowModel.reqPause && !powerSource.reqPause
-
-    // detect TTY switch and pause wallpaper(s)
-    TTYSwitchMonitor {
-        id: ttyMonitor
-        onTtySwitch: {
-            if (sleep) {
-                console.log("Preparing for sleep (possibly a VT switch)");
-                this.pause();
-            } else {
-                console.log("Waking up (VT switch back)");
-                this.play();
-            }
-        }
+    property bool   ok: !windowModel.reqPause && sessionPolicy.policy < SessionPolicy.Paused
+    // backends lower their frame rate
+    readonly property bool reduced: sessionPolicy.policy === SessionPolicy.Reduced || windowModel.reqReduce
+    readonly property bool unloaded: sessionPolicy.policy === SessionPolicy.Unloaded
+
+    // sleep, VT switch, lock, screensaver, battery and power profile, shared by all screens
+    SessionPolicy {
+        id: sessionPolicy
+        batteryPolicy: background.pauseOnBatPower
+            ? SessionPolicy.Paused
+            : (background.reduceOnBatPower ? SessionPolicy.Reduced : SessionPolicy.Full)
+        lowBattery: background.pauseBatPercent
+        powerSaverPolicy: background.reduceOnPowerSaver ? SessionPolicy.Reduced : SessionPolicy.Full
+        unloadAfter: background.unloadAfter * 60
+    }
+    onUnloadedChanged: {
+        if(unloaded) backendLoader.unload();
+        else loadBackend();
+    }
+
+    Timer {
+        id: deepPauseTimer
+        running: !background.ok && !background.deepPaused && background.deepPauseAfter > 0
+        repeat: false
+        interval: background.deepPauseAfter * 60 * 1000
+        onTriggered: background.deepPause()
+    }
+    function deepPause() {
+        const item = backendLoader.item;
+        if(!item || background.nowBackend === "InfoShow") return;
+        trace.instant("deepPause", background.wallpaperPath);
+        const state = {
+            source: background.wallpaperPath,
+            properties: typeof item.saveState === 'function' ? item.saveState() : {}
+        };
+        const size = Qt.size(backendLoader.width * Screen.devicePixelRatio,
+                             backendLoader.height * Screen.devicePixelRatio);
+        const ok = backendLoader.grabToImage((result) => {
+            // resumed or switched while grabbing
+            if(background.ok || backendLoader.item !== item) return;
+            frozenFrame.hold(result);
+            snapshot.save(result.image);
+            background.resumeState = state;
+            background.deepPaused = true;
+            backendLoader.unload();
+        }, size);
+        if(!ok) console.error("deep pause: can't grab last frame");
     }
 
     property string nowBackend: ""
@@ -77,7 +127,77 @@ Rectangle {
     property string wallpaperPath
     property string wallpaperType
 
+    // backend released after a long pause, only its last frame is shown
+    property bool deepPaused: false
+    // what the released backend needs to continue, e.g. mpv position
+    property var  resumeState: null
+
+    // the current backend has drawn, snapshots of it are worth keeping
+    property bool liveFrame: false
+
+    // switch and loader phases, off unless WEKDE_TRACE=1 or turned on in settings
+    TraceRecorder {
+        id: trace
+    }
+
+    // last frame of this wallpaper on this screen, shown while a backend starts
+    FrameSnapshot {
+        id: snapshot
+        key: background.wallpaperPath
+            ? `${background.wallpaperPath}@${Math.round(backendLoader.width * Screen.devicePixelRatio)}x${Math.round(backendLoader.height * Screen.devicePixelRatio)}`
+            : ""
+        onUrlChanged: {
+            if(!background.liveFrame && url.toString()) frozenFrame.show(url);
+        }
+    }
+    // grab the live backend, done() runs after the grab even if it never comes
+    function saveSnapshot(done) {
+        const finish = () => { if(done) { const d = done; done = null; d(); } };
+        const item = backendLoader.item;
+        if(!item || !background.liveFrame || background.nowBackend === "InfoShow") {
+            finish();
+            return;
+        }
+        const key = snapshot.key;
+        const size = Qt.size(backendLoader.width * Screen.devicePixelRatio,
+                             backendLoader.height * Screen.devicePixelRatio);
+        const ok = backendLoader.grabToImage((result) => {
+            trace.instant("snapshot", key);
+            snapshot.save(result.image, key);
+            finish();
+        }, size);
+        if(!ok) finish();
+        // nothing is rendered while the screen is off
+        else if(done) snapshotGuard.start(finish);
+    }
+    Timer {
+        id: snapshotGuard
+        interval: 500
+        property var pending: null
+        function start(fn) {
+            this.pending = fn;
+            this.restart();
+        }
+        onTriggered: {
+            const fn = this.pending;
+            this.pending = null;
+            if(fn) fn();
+        }
+    }
+    // refresh once the backend settled, pause and switch refresh it again
+    Timer {
+        id: snapshotTimer
+        interval: 3000
+        onTriggered: background.saveSnapshot(null)
+    }
+
     signal sig_backendFirstFrame(string backname)
+    onSig_backendFirstFrame: {
+        trace.end("switch", background.wallpaperPath);
+        background.liveFrame = true;
+        frozenFrame.release();
+        snapshotTimer.restart();
+    }
     function onBackendFirstFrame(backname) {
         console.error(`backend ${backname} first frame`);
         if (wallpaper.hasOwnProperty('accentColor'))
@@ -91,15 +211,31 @@ Rectangle {
     }
 
     function applySource() {
+        const { path } = Common.unpackWallpaperSource(source);
+        if(path !== background.wallpaperPath) trace.begin("switch", path, path);
+        // keep the frame of what is switched away from
+        if(background.wallpaperPath && path !== background.wallpaperPath && background.liveFrame)
+            saveSnapshot(doApplySource);
+        else
+            doApplySource();
+    }
+    function doApplySource() {
         const { path, type } = Common.unpackWallpaperSource(source);
         const path_changed = background.wallpaperPath !== path;
         const type_changed = background.wallpaperType !== type;
         const is_infobackend = background.nowBackend === "InfoShow";
 
         if(type_changed) wallpaperType = type;
-        if(path_changed) wallpaperPath = path;
+        if(path_changed) {
+            background.liveFrame = false;
+            wallpaperPath = path;
+        }
 
-        if(type_changed || is_infobackend || !source) {
+        if(background.unloaded) {
+            // picked up when loaded again
+        } else if(path_changed && !is_infobackend && backendLoader.takeNext(path)) {
+            // warm backend is already showing its first frame
+        } else if(type_changed || is_infobackend || !source || !backendLoader.item) {
             loadBackend();
         } else if(path_changed) {
             backendLoader.item.source = path;
@@ -164,6 +300,7 @@ Rectangle {
                         anchors.fill: parent
                     }
             `, screenGrid);
+            background.mouseHooker.fps = Qt.binding(() => background.fps);
             return true;
        }
        return false;
@@ -177,14 +314,6 @@ Rectangle {
         resumeTime: wallpaper.configuration.ResumeTime
     }
 
-    PowerSource {
-        id: powerSource
-        readonly property bool reqPause: {
-            (background.pauseOnBatPower && (st_battery_state == 'NoCharge' || st_battery_state == 'Discharging')) ||
-            (background.pauseBatPercent !== 0 && st_battery_has && st_battery_percent < background.pauseBatPercent)
-        }
-    }
-
     Pyext {
         id: pyext
     }
@@ -212,13 +341,49 @@ Rectangle {
         running: background.randomizeWallpaper
         interval: background.switchTimer * 1000 * 60
         repeat: true
+        onRunningChanged: running ? prefetchTimer.restart() : prefetchTimer.stop()
         onTriggered: {
             if(!(background.noRandomWhilePaused && !background.ok)) {
-                const i = Math.round(Math.random() * wpListModel.model.count);
-                wpListModel.changeWallpaper(i);
+                wpListModel.changeWallpaper(background.takeNextIndex());
             }
+            prefetchTimer.restart();
         }
     }
+    // pick the next wallpaper ahead of the switch, read it into the page cache
+    // and bring up its backend paused on the first frame
+    property int    nextIndex: -1
+    property string nextSource: ""
+    Timer {
+        id: prefetchTimer
+        repeat: false
+        interval: Math.max(1000, randomizeTimer.interval - Math.min(30 * 1000, randomizeTimer.interval / 2))
+        onTriggered: background.prefetchNext()
+    }
+    function prefetchNext() {
+        const count = wpListModel.model.count;
+        if(count === 0) return;
+        const i = Math.floor(Math.random() * count);
+        const source = Common.packWallpaperSource(wpListModel.model.get(i));
+        const { path, type } = Common.unpackWallpaperSource(source);
+        if(!path || path === background.wallpaperPath) return;
+        background.nextIndex = i;
+        background.nextSource = source;
+        // a scene or web page is the whole folder, a video only its file
+        const native = Common.urlNative(path);
+        const target = type === 'video' ? native : native.substring(0, native.lastIndexOf('/'));
+        pyext.prefetch(target).catch(reason => console.error(`prefetch: ${reason}`));
+        // a paused or unloaded wallpaper stays light
+        if(background.ok && background.hasLib) backendLoader.preload(type, path);
+    }
+    function takeNextIndex() {
+        const count = wpListModel.model.count;
+        const i = background.nextIndex;
+        background.nextIndex = -1;
+        // the list may have changed since
+        if(i >= 0 && i < count && Common.packWallpaperSource(wpListModel.model.get(i)) === background.nextSource)
+            return i;
+        return Math.floor(Math.random() * count);
+    }
 
     // lauch pause time to avoid freezing
     Timer {
@@ -227,7 +392,7 @@ Rectangle {
         repeat: false
         interval: 300
         onTriggered: {
-            backendLoader.item.pause();
+            if(backendLoader.item) backendLoader.item.pause();
             playTimer.start();
         }
     }
@@ -264,6 +429,53 @@ Rectangle {
 
         signal loaded
 
+        // last frame of a released backend, until the next one draws
+        Image {
+            id: frozenFrame
+            anchors.fill: parent
+            z: 1
+            visible: source != ""
+            cache: false
+            asynchronous: true
+            fillMode: Image.Stretch
+            property var grab: null
+            function hold(result) {
+                this.grab = result;
+                this.show(result.url);
+            }
+            function show(url) {
+                fadeOut.stop();
+                this.opacity = 1;
+                this.source = url;
+            }
+            // cross-fade to the live backend
+            function release() {
+                releaseTimer.stop();
+                if(this.visible && !fadeOut.running) fadeOut.start();
+            }
+            NumberAnimation {
+                id: fadeOut
+                target: frozenFrame
+                property: "opacity"
+                to: 0
+                duration: 400
+                onFinished: {
+                    frozenFrame.source = "";
+                    frozenFrame.grab = null;
+                }
+            }
+            // for backends that never report a first frame
+            Timer {
+                id: releaseTimer
+                onTriggered: frozenFrame.release()
+            }
+            function releaseLater(ms) {
+                if(!this.visible) return;
+                releaseTimer.interval = ms;
+                releaseTimer.restart();
+            }
+        }
+
         Component.onCompleted: {
             if(background.hasLib) {
                 this.loaded.connect(this.changeMouseTarget);
@@ -271,6 +483,7 @@ Rectangle {
             }
         }
         Component.onDestruction: {
+            this.dropNext();
             if(this.item) this.item.destroy();
         }
         function load(url, properties) {
@@ -289,7 +502,74 @@ Rectangle {
                 this.loadInfoShow(com.errorString());
             }
         }
+        function unload() {
+            this.dropNext();
+            if(this.item) this.item.destroy();
+            this.item = null;
+        }
+
+        // next wallpaper, paused on its first frame below the current one
+        property var next: null
+        property string nextSource: ""
+        function preload(type, path) {
+            this.dropNext();
+            const backend = background.chooseBackend(type, path);
+            // only these can hold a paused first frame
+            if(backend.info || !["backend/Mpv.qml", "backend/Scene.qml"].includes(backend.qmlsource))
+                return;
+            const com = Qt.createComponent(backend.qmlsource);
+            if(com.status !== Component.Ready) return;
+            backend.properties.preloading = true;
+            // drawn under the current backend, so it still renders its first frame
+            backend.properties.z = -1;
+            try {
+                trace.instant("preload", path);
+                this.next = com.createObject(this, backend.properties);
+                this.nextSource = path;
+            } catch(e) {
+                this.next = null;
+            }
+        }
+        function dropNext() {
+            if(this.next) this.next.destroy();
+            this.next = null;
+            this.nextSource = "";
+        }
+        // swap in the preloaded backend, false if it is not for path
+        function takeNext(path) {
+            if(!this.next || this.nextSource !== path || !this.next.ready) {
+                this.dropNext();
+                return false;
+            }
+            trace.instant("takeNext", path);
+            const old = this.item;
+            this.item = this.next;
+            this.next = null;
+            this.nextSource = "";
+            this.item.z = 0;
+            this.item.preloading = false;
+            if(old) {
+                crossFade.complete();
+                old.z = 1;
+                crossFade.target = old;
+                crossFade.start();
+            }
+            this.loaded();
+            background.sig_backendFirstFrame(background.nowBackend);
+            return true;
+        }
+        NumberAnimation {
+            id: crossFade
+            property: "opacity"
+            to: 0
+            duration: 400
+            onFinished: {
+                if(this.target) this.target.destroy();
+                this.target = null;
+            }
+        }
         function loadInfoShow(info) {
+            frozenFrame.release();
             this.load("backend/InfoShow.qml", {
                 wid: background.workshopid,
                 type: background.wallpaperType,
@@ -306,18 +586,13 @@ Rectangle {
         }
     }
 
-    function loadBackend() {
+    // qml file and properties of the backend for a wallpaper, or the info to show instead
+    function chooseBackend(type, path) {
         let qmlsource = "";
         let properties = {};
 
-    
-        // check source
-        if(!background.source) {
-            backendLoader.loadInfoShow("Source is empty. The config may be broken.");
-            return;
-        }
         // choose backend
-        switch (background.wallpaperType) {
+        switch (type) {
             case 'video':
                 if(background.videoBackend == Common.VideoBackend.Mpv && background.hasLib)
                     qmlsource = "backend/Mpv.qml";
@@ -333,24 +608,60 @@ Rectangle {
                     qmlsource = "backend/Scene.qml";
                     properties = {"assets": Common.getAssetsPath(steamlibrary)};
                 } else {
-                    backendLoader.loadInfoShow("Plugin lib not found. To support scene, please compile and install it.");
-                    return; 
+                    return { info: "Plugin lib not found. To support scene, please compile and install it." };
                 }
                 break;
             default:
-                backendLoader.loadInfoShow("Not supported wallpaper type");
-                return; 
+                return { info: "Not supported wallpaper type" };
         }
-        properties['source'] = background.wallpaperPath;
+        properties['source'] = path;
+        return { qmlsource, properties };
+    }
+
+    function loadBackend() {
+        if(background.unloaded) return;
+        backendLoader.dropNext();
+
+        // check source
+        if(!background.source) {
+            backendLoader.loadInfoShow("Source is empty. The config may be broken.");
+            return;
+        }
+        const backend = chooseBackend(background.wallpaperType, background.wallpaperPath);
+        if(backend.info) {
+            backendLoader.loadInfoShow(backend.info);
+            return;
+        }
+        const { qmlsource, properties } = backend;
+        // continue where the released backend stopped
+        if(background.resumeState && background.resumeState.source === background.wallpaperPath)
+            Object.assign(properties, background.resumeState.properties);
+        background.resumeState = null;
+        background.deepPaused = false;
+        background.liveFrame = false;
+        if(!frozenFrame.visible && snapshot.url.toString()) frozenFrame.show(snapshot.url);
+        // QtMultimedia has no first frame signal, give others time for a slow scene load
+        frozenFrame.releaseLater(qmlsource === "backend/QtMultimedia.qml" ? 1000 : 30000);
         console.error("load backend: "+qmlsource);
+        trace.begin("loadBackend", qmlsource, qmlsource);
         backendLoader.load(qmlsource, properties);
+        trace.end("loadBackend", qmlsource);
         sourceCallback();
     }
    
     function autoPause() {
-        background.ok
-            ? backendLoader.item.play()
-            : backendLoader.item.pause();
+        if(background.deepPaused) {
+            if(background.ok) loadBackend();
+            return;
+        }
+        if(!backendLoader.item) return;
+        if(background.ok) {
+            backendLoader.item.play();
+        } else {
+            backendLoader.item.pause();
+            // the paused frame is what the next start shows
+            snapshotTimer.restart();
+        }
     }
 
     Component.onCompleted: {
@@ -364,6 +675,7 @@ Rectangle {
 
         lauchPauseTimer.start();
         randomizeTimer.start();
+        if(randomizeTimer.running) prefetchTimer.restart();
     }
 }
 }
@@ -16,10 +16,14 @@ Flickable {
     property alias cfg_Fps: sliderFps.value
     property alias cfg_Volume: sliderVol.value
     property alias cfg_MpvStats: ckbox_mpvStats.checked
+    property alias cfg_MpvDirect: ckbox_mpvDirect.checked
+    property alias cfg_TranscodeVideo: ckbox_transcodeVideo.checked
+    property alias cfg_TranscodeCacheSize: spin_transcodeCacheSize.value
     property alias cfg_Speed: spin_speed.dValue
     property alias cfg_MuteAudio: ckbox_muteAudio.checked
     property alias cfg_MouseInput: ckbox_mouseInput.checked
     property alias cfg_ResumeTime: resumeSpin.value
+    property alias cfg_DeepPauseAfter: deepPauseSpin.value
     property alias cfg_SwitchTimer: randomSpin.value
     property alias cfg_RandomizeWallpaper: ckbox_randomizeWallpaper.checked
     property alias cfg_NoRandomWhilePaused: ckbox_noRandomWhilePaused.checked
@@ -27,6 +31,10 @@ Flickable {
 
     property alias cfg_PauseOnBatPower: chkbox_pauseOnBatPower.checked
     property alias cfg_PauseBatPercent: spin_pauseBatPercent.value
+    property alias cfg_ReduceOnBatPower: chkbox_reduceOnBatPower.checked
+    property alias cfg_ReduceOnPowerSaver: chkbox_reduceOnPowerSaver.checked
+    property alias cfg_AdaptiveQuality: chkbox_adaptiveQuality.checked
+    property alias cfg_UnloadAfter: spin_unloadAfter.value
     property int   cfg_Rotation
 
 
@@ -74,6 +82,10 @@ Flickable {
                             text: "FullScreen",
                             value: Common.PauseMode.FullScreen
                         },
+                        {
+                            text: "Covered Wallpaper",
+                            value: Common.PauseMode.Covered
+                        },
                         {
                             text: "Any Window",
                             value: Common.PauseMode.Any
@@ -91,7 +103,7 @@ Flickable {
                     Text {
                         Layout.fillWidth: true
                         color: Theme.disabledTextColor
-                        text: "Automatically pauses playback if any/focus/maximized window detected"
+                        text: "Automatically pauses playback if any/focus/maximized window detected, or when windows cover the whole wallpaper. Playback slows down while windows cover most of it"
                         wrapMode: Text.Wrap
                     }
                }
@@ -110,6 +122,14 @@ Flickable {
                     id: chkbox_pauseOnBatPower
                 }
             }
+            OptionItem {
+                text: 'Lower frame rate if PC is on battery power'
+                text_color: Theme.textColor
+                visible: !chkbox_pauseOnBatPower.checked
+                actor: Switch {
+                    id: chkbox_reduceOnBatPower
+                }
+            }
             OptionItem {
                 text: 'Pause if battery level is below'
                 text_color: Theme.textColor
@@ -120,6 +140,38 @@ Flickable {
                         stepSize: 1
                 }
             }
+            OptionItem {
+                text: 'Lower frame rate in power saver mode'
+                text_color: Theme.textColor
+                actor: Switch {
+                    id: chkbox_reduceOnPowerSaver
+                }
+            }
+            OptionItem {
+                text: 'Adapt quality to load'
+                text_color: Theme.textColor
+                actor: Switch {
+                    id: chkbox_adaptiveQuality
+                }
+                contentBottom: ColumnLayout {
+                    Text {
+                        Layout.fillWidth: true
+                        color: Theme.disabledTextColor
+                        text: "Step down frame rate, then render and decode resolution while the wallpaper renders slowly, drops frames or the system is busy, and back up once it settles"
+                        wrapMode: Text.Wrap
+                    }
+                }
+            }
+            OptionItem {
+                text: 'Unload if locked or switched away for (minutes, 0 never)'
+                text_color: Theme.textColor
+                actor: SpinBox {
+                        id: spin_unloadAfter
+                        from: 0
+                        to: 600
+                        stepSize: 5
+                }
+            }
             OptionItem {
                 text: 'Display'
                 text_color: Theme.textColor
@@ -187,6 +239,31 @@ Flickable {
                     }
                 }
             }
+            OptionItem {
+                text: 'Deep Pause'
+                text_color: Theme.textColor
+                icon: '../../images/timer.svg'
+                actor: RowLayout {
+                    spacing: 0
+                    RowLayout {
+                        SpinBox {
+                            id: deepPauseSpin
+                            from: 0
+                            to: 24*60
+                            stepSize: 1
+                        }
+                        Label { text: " min" }
+                    }
+                }
+                contentBottom: ColumnLayout {
+                    Text {
+                        Layout.fillWidth: true
+                        color: Theme.disabledTextColor
+                        text: "Keep only the last frame after being paused this long, which frees the decoder and gpu memory. 0 disables"
+                        wrapMode: Text.Wrap
+                    }
+                }
+            }
             OptionItem {
                 text: 'Randomize Timer'
                 text_color: Theme.textColor
@@ -328,6 +405,51 @@ Flickable {
                     id: ckbox_mpvStats
                 }
             }
+            OptionItem {
+                text: 'Draw video directly'
+                text_color: Theme.textColor
+                icon: '../../images/tuning.svg'
+                visible: cfg_VideoBackend == Common.VideoBackend.Mpv
+                actor: Switch {
+                    id: ckbox_mpvDirect
+                }
+                contentBottom: ColumnLayout {
+                    Text {
+                        Layout.fillWidth: true
+                        color: Theme.disabledTextColor
+                        text: "Skip the intermediate texture and its extra full screen copy per frame, OpenGL only, applies to the next wallpaper loaded"
+                        wrapMode: Text.Wrap
+                    }
+                }
+            }
+            OptionItem {
+                text: 'Transcode heavy videos'
+                text_color: Theme.textColor
+                icon: '../../images/tuning.svg'
+                visible: cfg_VideoBackend == Common.VideoBackend.Mpv
+                actor: Switch {
+                    id: ckbox_transcodeVideo
+                }
+                contentBottom: ColumnLayout {
+                    Text {
+                        Layout.fillWidth: true
+                        color: Theme.disabledTextColor
+                        text: "When a video decodes in software and is larger, faster or harder to decode than the screen needs, encode a matching copy in the background and play that next time"
+                        wrapMode: Text.Wrap
+                    }
+                }
+            }
+            OptionItem {
+                text: 'Transcode cache size (MiB)'
+                text_color: Theme.textColor
+                visible: cfg_VideoBackend == Common.VideoBackend.Mpv && ckbox_transcodeVideo.checked
+                actor: SpinBox {
+                    id: spin_transcodeCacheSize
+                    from: 256
+                    to: 65536
+                    stepSize: 256
+                }
+            }
         }
         OptionGroup {
             Layout.fillWidth: true
@@ -406,6 +528,47 @@ Flickable {
                 }
             }
         }
+        OptionGroup {
+            Layout.fillWidth: true
+
+            header.text: 'Debug'
+            header.text_color: Theme.textColor
+            header.icon: '../../images/cheveron-down.svg'
+            header.color: Theme.activeBackgroundColor
+            visible: trace_recorder !== null
+
+            OptionItem {
+                text: 'Record trace'
+                text_color: Theme.textColor
+                icon: '../../images/information-outline.svg'
+                actor: RowLayout {
+                    Switch {
+                        checked: trace_recorder ? trace_recorder.enabled : false
+                        onToggled: trace_recorder.enabled = checked
+                    }
+                    Button {
+                        text: 'Save'
+                        enabled: trace_recorder ? trace_recorder.enabled : false
+                        onClicked: trace_recorder.save()
+                    }
+                }
+                contentBottom: ColumnLayout {
+                    Text {
+                        id: traceText
+                        Layout.fillWidth: true
+                        color: Theme.disabledTextColor
+                        wrapMode: Text.Wrap
+                        text: "Records wallpaper switches and mpv frames until plasma restarts, open the saved file in ui.perfetto.dev"
+                        Connections {
+                            target: trace_recorder
+                            function onSaved(path) {
+                                traceText.text = path ? `Saved to ${path}` : "Can't save trace";
+                            }
+                        }
+                    }
+                }
+            }
+        }
     }
 
 
@@ -50,6 +50,12 @@ RowLayout {
                     //${cfg_WallpaperType}
                 }
 
+                Kirigami.SearchField {
+                    Layout.preferredWidth: Kirigami.Units.gridUnit * 10
+                    placeholderText: "Search title, tag or id"
+                    onTextChanged: wpListModel.searchStr = text
+                }
+
                 Kirigami.ActionToolBar {
                     Layout.fillWidth: true
                     alignment: Qt.AlignRight
@@ -211,6 +217,7 @@ RowLayout {
                     view.implicitCellHeight: Screen.height / 10 + Kirigami.Units.smallSpacing * 2 + Kirigami.Units.gridUnit * 3
                     view.model: defaultModel
                     view.delegate: KCM.GridDelegate {
+                        id: wpDelegate
                         // path is file://, safe to concat with '/'
                         text: title
                         hoverEnabled: true
@@ -244,7 +251,12 @@ RowLayout {
                             Image {
                                 id: imgPre
                                 anchors.fill: parent
-                                source: Common.getWpModelPreviewSource(model);
+                                // static first frame from the plugin's thumbnail cache
+                                source: {
+                                    const src = Common.getWpModelPreviewSource(model);
+                                    if(!src || !libcheck.wallpaper) return src;
+                                    return 'image://wekdethumb/' + encodeURIComponent(Common.urlNative(src));
+                                }
                                 sourceSize.width: parent.width
                                 sourceSize.height: parent.height
                                 fillMode: Image.PreserveAspectCrop//Image.Stretch
@@ -253,6 +265,18 @@ RowLayout {
                                 smooth: true
                                 visible: Boolean(preview)
                             }
+                            // only the hovered item animates
+                            Loader {
+                                anchors.fill: parent
+                                active: libcheck.wallpaper && wpDelegate.hovered && /\.gif$/i.test(preview || '')
+                                sourceComponent: AnimatedImage {
+                                    source: Common.getWpModelPreviewSource(model)
+                                    fillMode: Image.PreserveAspectCrop
+                                    asynchronous: true
+                                    cache: false
+                                    playing: status == AnimatedImage.Ready
+                                }
+                            }
                         }
                         onClicked: {
                             cfg_WallpaperSource = Common.packWallpaperSource(model);
@@ -533,12 +557,14 @@ RowLayout {
                         const tags = right_content.wpmodel.tags;
                         const playlists = right_content.wpmodel.playlists;
                         const _model = this.model;
+                        // ListModel rows from qml, plain arrays from the native model
+                        const at = (list, i) => list.get ? list.get(i) : list[i];
                         _model.clear();
                         for(const i of Array(tags.length).keys())
-                            _model.append(tags.get(i));
+                            _model.append(at(tags, i));
                         for(const i of Array(playlists.length).keys()){
-                            var playlist = playlists.get(i);
-                            if(playlist != null) { _model.append(playlists.get(i)); }
+                            var playlist = at(playlists, i);
+                            if(playlist != null) { _model.append(playlist); }
                         }
                         _model.append({key: wpmodel.contentrating});
                         return true;
@@ -628,12 +654,12 @@ RowLayout {
                         config_resets.forEach((wid) => {
                             pyext.reset_wallpaper_config(wid).then(res => {});
                         });
-                        Object.entries(config_changes).forEach(([wid, cfg]) => {
-                            pyext.write_wallpaper_config(wid, cfg).then(res => {
-                                if(wid == workshopid)
-                                    this.cofnig.update(this.config_changes);
-                                this.config_changes = {};
-                            });
+                        // all wallpapers in one batch, the native store writes each file once
+                        const changes = this.config_changes;
+                        this.config_changes = {};
+                        pyext.update_wallpaper_configs(changes).then(res => {
+                            if(changes[workshopid])
+                                this.config = Object.assign({}, this.config, changes[workshopid]);
                         });
 
                         config_resets.clear();
@@ -0,0 +1,279 @@
+#include "FileService.hpp"
+#include <QLoggingCategory>
+#include <QThreadPool>
+#include <QPointer>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDirIterator>
+#include <QStandardPaths>
+#include <QQmlEngine>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Q_LOGGING_CATEGORY(wekdeFile, "wekde.file")
+
+using namespace wekde;
+
+namespace
+{
+constexpr qint64 PrefetchBudget { 512ll * 1024 * 1024 };
+
+// read-only private mapping of a whole file
+class MappedFile {
+public:
+    MappedFile(const QString& path) {
+        int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            m_error = QString::fromLocal8Bit(std::strerror(errno));
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || ! S_ISREG(st.st_mode)) {
+            m_error = "not a regular file";
+            ::close(fd);
+            return;
+        }
+        m_size = st.st_size;
+        if (m_size > 0) {
+            void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                m_error = QString::fromLocal8Bit(std::strerror(errno));
+                m_size  = 0;
+            } else {
+                ::madvise(p, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const char*>(p);
+            }
+        }
+        ::close(fd);
+        m_ok = m_error.isEmpty();
+    }
+    ~MappedFile() {
+        if (m_data) ::munmap(const_cast<char*>(m_data), m_size);
+    }
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool           ok() const { return m_ok; }
+    const QString& error() const { return m_error; }
+    const char*    data() const { return m_data; }
+    qsizetype      size() const { return m_size; }
+
+private:
+    bool        m_ok { false };
+    QString     m_error;
+    const char* m_data { nullptr };
+    qsizetype   m_size { 0 };
+};
+
+bool StatxAt(int dirfd, const char* name, struct statx* stx) {
+    return ::statx(dirfd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, STATX_TYPE | STATX_SIZE,
+                   stx) == 0;
+}
+
+// files of dirfd and below, depth counts levels left including this one
+qint64 WalkDir(int dirfd, int depth) {
+    DIR* d = ::fdopendir(dirfd);
+    if (! d) {
+        ::close(dirfd);
+        return 0;
+    }
+    qint64 size { 0 };
+    while (auto* ent = ::readdir(d)) {
+        const char* name = ent->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+        bool is_dir = ent->d_type == DT_DIR;
+        if (ent->d_type == DT_UNKNOWN || ent->d_type == DT_REG) {
+            struct statx stx;
+            if (! StatxAt(::dirfd(d), name, &stx)) continue;
+            if (S_ISREG(stx.stx_mode)) size += stx.stx_size;
+            is_dir = S_ISDIR(stx.stx_mode);
+        }
+        if (is_dir && depth != 1) {
+            int fd = ::openat(::dirfd(d), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd >= 0) size += WalkDir(fd, depth > 0 ? depth - 1 : 0);
+        }
+    }
+    ::closedir(d);
+    return size;
+}
+
+qint64 ScanDirSize(const QString& path, int depth) {
+    int root = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root < 0) return -1;
+    DIR* d = ::fdopendir(root);
+    if (! d) {
+        ::close(root);
+        return -1;
+    }
+
+    // top level inline, each sub dir is a job for the workers
+    qint64           size { 0 };
+    std::vector<int> subdirs;
+    while (auto* ent = ::readdir(d)) {
+        const char* name = ent->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+        struct statx stx;
+        if (! StatxAt(::dirfd(d), name, &stx)) continue;
+        if (S_ISREG(stx.stx_mode))
+            size += stx.stx_size;
+        else if (S_ISDIR(stx.stx_mode) && depth != 1) {
+            int fd = ::openat(::dirfd(d), name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd >= 0) subdirs.push_back(fd);
+        }
+    }
+    ::closedir(d);
+
+    const int           sub_depth = depth > 0 ? depth - 1 : 0;
+    std::atomic<int>    next { 0 };
+    std::atomic<qint64> total { size };
+    auto                work = [&]() {
+        for (int i = next++; i < (int)subdirs.size(); i = next++)
+            total += WalkDir(subdirs[i], sub_depth);
+    };
+    const int threads =
+        std::clamp<int>(std::thread::hardware_concurrency(), 1, std::max<int>(1, subdirs.size()));
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++) workers.emplace_back(work);
+    work();
+    for (auto& t : workers) t.join();
+    return total;
+}
+} // namespace
+
+FileService::FileService(QObject* parent): QObject(parent) {}
+
+FileService::~FileService() {}
+
+QString FileService::WallpaperConfigDir() {
+    return QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) +
+           "/wekde/wallpaper";
+}
+
+qint64 FileService::DirSize(const QString& path, int depth) {
+    // no cache, nothing short of the walk itself sees a file rewritten deep below path
+    return ScanDirSize(path, depth);
+}
+
+qint64 FileService::Prefetch(const QString& path, qint64 budget) {
+    auto hint = [](const QString& file) -> qint64 {
+        int fd = ::open(QFile::encodeName(file).constData(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return 0;
+        struct stat st;
+        qint64      size { 0 };
+        if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED) == 0)
+            size = st.st_size;
+        ::close(fd);
+        return size;
+    };
+
+    const QFileInfo info(path);
+    if (! info.isDir()) return hint(path);
+
+    qint64       total { 0 };
+    QDirIterator it(path, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext() && total < budget) total += hint(it.next());
+    return total;
+}
+
+void FileService::run(const QJSValue& callback, Task task) {
+    // QJSValue stays on this thread, workers only see the id
+    const int id = m_next_id++;
+    m_callbacks.insert(id, callback);
+
+    QPointer<FileService> self(this);
+    QThreadPool::globalInstance()->start([self, id, task]() {
+        QString  error;
+        QVariant result = task(&error);
+        if (! self) return;
+        QMetaObject::invokeMethod(
+            self.data(),
+            [self, id, error, result]() {
+                if (self) self->finish(id, error, result);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void FileService::finish(int id, const QString& error, const QVariant& result) {
+    QJSValue callback = m_callbacks.take(id);
+    if (! callback.isCallable()) return;
+    auto* engine = qjsEngine(this);
+    if (! engine) return;
+    QJSValue jerror = error.isEmpty() ? QJSValue(QJSValue::NullValue) : QJSValue(error);
+    QJSValue ret    = callback.call({ jerror, engine->toScriptValue(result) });
+    if (ret.isError()) qCWarning(wekdeFile) << "callback:" << ret.toString();
+}
+
+void FileService::readfile(const QString& path, const QJSValue& callback) {
+    run(callback, [path](QString* error) -> QVariant {
+        MappedFile f(path);
+        if (! f.ok()) {
+            *error = path + ": " + f.error();
+            return {};
+        }
+        return QString::fromUtf8(f.data(), f.size());
+    });
+}
+
+void FileService::readbuffer(const QString& path, const QJSValue& callback) {
+    run(callback, [path](QString* error) -> QVariant {
+        MappedFile f(path);
+        if (! f.ok()) {
+            *error = path + ": " + f.error();
+            return {};
+        }
+        return QByteArray(f.data(), f.size());
+    });
+}
+
+void FileService::get_dir_size(const QString& path, int depth, const QJSValue& callback) {
+    run(callback, [path, depth](QString* error) -> QVariant {
+        const qint64 size = DirSize(path, depth);
+        if (size < 0) {
+            *error = path + ": can't read dir";
+            return {};
+        }
+        return double(size);
+    });
+}
+
+void FileService::delete_wallpaper(const QString& path, const QString& workshopid,
+                                   const QJSValue& callback) {
+    run(callback, [path, workshopid](QString*) -> QVariant {
+        // same safety rules as pyext: only folders with a project.json
+        const QString folder = QFileInfo(path).canonicalFilePath();
+        if (folder.isEmpty() || ! QFileInfo(folder).isDir())
+            return QVariantMap { { "ok", false }, { "error", "not a directory" } };
+        if (! QFileInfo(folder + "/project.json").isFile())
+            return QVariantMap { { "ok", false }, { "error", "not a wallpaper folder" } };
+
+        if (! QDir(folder).removeRecursively())
+            return QVariantMap { { "ok", false }, { "error", "remove failed: " + folder } };
+        if (! workshopid.isEmpty()) QFile::remove(WallpaperConfigDir() + '/' + workshopid + ".json");
+        return QVariantMap { { "ok", true } };
+    });
+}
+
+void FileService::prefetch(const QString& path, const QJSValue& callback) {
+    run(callback, [path](QString* error) -> QVariant {
+        if (! QFileInfo::exists(path)) {
+            *error = path + ": not found";
+            return {};
+        }
+        // spinning disks take a few seconds for this
+        return double(Prefetch(path, PrefetchBudget));
+    });
+}
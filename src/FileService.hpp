@@ -0,0 +1,46 @@
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QJSValue>
+#include <QVariant>
+#include <functional>
+
+namespace wekde
+{
+
+// native replacement of pyext file methods, same names as the jsonrpc ones
+// every call runs on the thread pool, callback(error, result) is invoked on the caller's thread
+class FileService : public QObject {
+    Q_OBJECT
+public:
+    FileService(QObject* parent = nullptr);
+    virtual ~FileService();
+
+    // text of file, decoded straight from a read-only mapping
+    Q_INVOKABLE void readfile(const QString& path, const QJSValue& callback);
+    // raw bytes as ArrayBuffer
+    Q_INVOKABLE void readbuffer(const QString& path, const QJSValue& callback);
+    // sum of file sizes up to depth levels below path, depth <= 0 means no limit
+    Q_INVOKABLE void get_dir_size(const QString& path, int depth, const QJSValue& callback);
+    // result: { ok, error }
+    Q_INVOKABLE void delete_wallpaper(const QString& path, const QString& workshopid,
+                                      const QJSValue& callback);
+    // native only, ask the kernel to read path or the files below it into the page cache
+    // result: bytes hinted
+    Q_INVOKABLE void prefetch(const QString& path, const QJSValue& callback);
+
+    // -1 on error
+    static qint64  DirSize(const QString& path, int depth);
+    static QString WallpaperConfigDir();
+    // returns without waiting for the reads, stops after budget bytes
+    static qint64  Prefetch(const QString& path, qint64 budget);
+
+private:
+    using Task = std::function<QVariant(QString* error)>;
+    void run(const QJSValue& callback, Task task);
+    void finish(int id, const QString& error, const QVariant& result);
+
+    int                  m_next_id { 0 };
+    QHash<int, QJSValue> m_callbacks;
+};
+} // namespace wekde
@@ -0,0 +1,92 @@
+#include "FrameSnapshot.hpp"
+#include <QLoggingCategory>
+#include <QCryptographicHash>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QThreadPool>
+#include <QPointer>
+
+#include "PluginInfo.hpp"
+
+Q_LOGGING_CATEGORY(wekdeSnapshot, "wekde.snapshot")
+
+using namespace wekde;
+
+namespace
+{
+constexpr int JpegQuality { 90 };
+// one per wallpaper and screen size ever shown, drop the oldest
+constexpr int MaxFiles { 32 };
+
+QString SnapshotDir() { return PluginInfo::cacheDir() + "/snapshots"; }
+
+void Prune() {
+    QDir dir(SnapshotDir());
+    auto files = dir.entryInfoList({ "*.jpg" }, QDir::Files, QDir::Time);
+    for (int i = MaxFiles; i < files.size(); i++) QFile::remove(files[i].absoluteFilePath());
+}
+} // namespace
+
+FrameSnapshot::FrameSnapshot(QObject* parent): QObject(parent) {}
+
+FrameSnapshot::~FrameSnapshot() {}
+
+void FrameSnapshot::setKey(const QString& key) {
+    if (key == m_key) return;
+    m_key = key;
+    updateUrl();
+    Q_EMIT keyChanged();
+}
+
+void FrameSnapshot::updateUrl() {
+    const QString path = Path(m_key);
+    const QUrl    url  = ! path.isEmpty() && QFileInfo::exists(path) ? QUrl::fromLocalFile(path) : QUrl();
+    if (url == m_url) return;
+    m_url = url;
+    Q_EMIT urlChanged();
+}
+
+QString FrameSnapshot::Path(const QString& key) {
+    if (key.isEmpty()) return {};
+    const auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    return SnapshotDir() + "/" + hash.toHex() + ".jpg";
+}
+
+bool FrameSnapshot::Write(const QImage& image, const QString& path) {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    // readers never see a half written file
+    QSaveFile f(path);
+    if (! f.open(QIODevice::WriteOnly)) return false;
+    QImageWriter writer(&f, "jpg");
+    writer.setQuality(JpegQuality);
+    const QImage rgb = image.hasAlphaChannel() ? image.convertToFormat(QImage::Format_RGB32) : image;
+    return writer.write(rgb) && f.commit();
+}
+
+void FrameSnapshot::save(const QVariant& image) { save(image, m_key); }
+
+void FrameSnapshot::save(const QVariant& v, const QString& key) {
+    const QImage  image = v.value<QImage>();
+    const QString path  = Path(key);
+    if (image.isNull() || path.isEmpty()) return;
+
+    QPointer<FrameSnapshot> self(this);
+    QThreadPool::globalInstance()->start([self, image, path, key]() {
+        if (! Write(image, path)) {
+            qCWarning(wekdeSnapshot) << "can't write snapshot:" << path;
+            return;
+        }
+        Prune();
+        if (! self) return;
+        QMetaObject::invokeMethod(
+            self.data(),
+            [self, key]() {
+                if (! self) return;
+                if (key == self->m_key) self->updateUrl();
+                Q_EMIT self->saved(key);
+            },
+            Qt::QueuedConnection);
+    });
+}
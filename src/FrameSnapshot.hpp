@@ -0,0 +1,45 @@
+#pragma once
+#include <QObject>
+#include <QImage>
+#include <QUrl>
+#include <QVariant>
+
+namespace wekde
+{
+
+// last rendered frame of a wallpaper, kept as jpeg under PluginInfo::cacheDir()
+// shown at the next start until the backend draws its first frame
+class FrameSnapshot : public QObject {
+    Q_OBJECT
+    // e.g. source and screen size, every key has its own file
+    Q_PROPERTY(QString key READ key WRITE setKey NOTIFY keyChanged)
+    // local file of the saved frame for key, empty if there is none
+    Q_PROPERTY(QUrl url READ url NOTIFY urlChanged)
+
+public:
+    FrameSnapshot(QObject* parent = nullptr);
+    virtual ~FrameSnapshot();
+
+    QString key() const { return m_key; }
+    QUrl    url() const { return m_url; }
+    void    setKey(const QString&);
+
+    // image is QQuickItemGrabResult.image, encoded on the thread pool
+    Q_INVOKABLE void save(const QVariant& image);
+    Q_INVOKABLE void save(const QVariant& image, const QString& key);
+
+    static QString Path(const QString& key);
+    static bool    Write(const QImage&, const QString& path);
+
+signals:
+    void keyChanged();
+    void urlChanged();
+    void saved(const QString& key);
+
+private:
+    void updateUrl();
+
+    QString m_key;
+    QUrl    m_url;
+};
+} // namespace wekde
@@ -0,0 +1,250 @@
+#include "FrameStats.hpp"
+#include "FrameClock.hpp"
+#include <QLoggingCategory>
+#include <QJsonDocument>
+#include <QQuickWindow>
+
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+
+Q_LOGGING_CATEGORY(wekdeStats, "wekde.stats")
+
+using namespace wekde;
+
+namespace
+{
+constexpr int DefaultInterval { 1000 };
+
+qint64 NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+qint64 RssKiB() {
+    qint64 out { 0 };
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        long size { 0 }, resident { 0 };
+        if (std::fscanf(f, "%ld %ld", &size, &resident) == 2)
+            out = resident * (sysconf(_SC_PAGESIZE) / 1024);
+        std::fclose(f);
+    }
+    return out;
+}
+} // namespace
+
+FrameStats::FrameStats(QObject* parent): QObject(parent) {
+    m_timer.setInterval(DefaultInterval);
+    connect(&m_timer, &QTimer::timeout, this, &FrameStats::sample);
+}
+
+FrameStats::~FrameStats() { detach(); }
+
+void FrameStats::setTarget(QQuickItem* target) {
+    if (target == m_target) return;
+    detach();
+    m_target = target;
+    attach();
+    Q_EMIT targetChanged();
+}
+
+void FrameStats::setActive(bool v) {
+    if (v == m_active) return;
+    detach();
+    m_active = v;
+    attach();
+    Q_EMIT activeChanged();
+}
+
+void FrameStats::setDetail(bool v) {
+    if (v == m_detail) return;
+    detach();
+    m_detail = v;
+    attach();
+}
+
+void FrameStats::setInterval(int v) {
+    v = std::max(100, v);
+    if (v == m_timer.interval()) return;
+    m_timer.setInterval(v);
+    Q_EMIT intervalChanged();
+}
+
+void FrameStats::attach() {
+    if (! m_active || ! m_target) return;
+
+    if (auto* mpv = qobject_cast<mpv::MpvObject*>(m_target.data())) {
+        m_backend = "mpv";
+        m_stats   = mpv->renderStats();
+        if (m_detail) {
+            m_watched = mpv;
+            mpv->watchDetail(true);
+        }
+    } else {
+        // no hook into the scene renderer, time the whole window instead
+        m_backend = "scene";
+        m_stats   = std::make_shared<mpv::RenderStats>();
+        auto hook = [this](QQuickWindow* win) {
+            disconnect(m_before);
+            disconnect(m_after);
+            if (! win) return;
+            auto stats = m_stats;
+            auto begin = std::make_shared<std::atomic<qint64>>(0);
+            // render thread
+            m_before = connect(
+                win,
+                &QQuickWindow::beforeRendering,
+                this,
+                [begin]() {
+                    begin->store(NowNs(), std::memory_order_relaxed);
+                },
+                Qt::DirectConnection);
+            m_after = connect(
+                win,
+                &QQuickWindow::afterRendering,
+                this,
+                [begin, stats]() {
+                    stats->redraws.fetch_add(1, std::memory_order_relaxed);
+                    stats->record(NowNs() - begin->load(std::memory_order_relaxed));
+                },
+                Qt::DirectConnection);
+        };
+        hook(m_target->window());
+        m_window = connect(m_target, &QQuickItem::windowChanged, this, hook);
+    }
+    m_stats->readers.fetch_add(1);
+    reset();
+    m_clock.start();
+    m_timer.start();
+}
+
+void FrameStats::detach() {
+    m_timer.stop();
+    disconnect(m_before);
+    disconnect(m_after);
+    disconnect(m_window);
+    if (m_stats) m_stats->readers.fetch_sub(1);
+    m_stats.reset();
+    if (m_watched) m_watched->watchDetail(false);
+    m_watched.clear();
+}
+
+void FrameStats::reset() {
+    m_last_frames  = m_stats->frames.load();
+    m_last_redraws = m_stats->redraws.load();
+    m_last_sum     = m_stats->sum_ns.load();
+    m_last_slow    = m_stats->slow_ns.load();
+    m_last_wakeups = mpv::FrameClock::Instance()->wakeups();
+    for (int i = 0; i < mpv::RenderStats::Buckets; i++) m_last_hist[i] = m_stats->histogram[i].load();
+    m_hist.fill(0);
+}
+
+QVariantList FrameStats::histogram() const {
+    int end = m_hist.size();
+    while (end > 0 && m_hist[end - 1] == 0) end--;
+    QVariantList out;
+    out.reserve(end);
+    for (int i = 0; i < end; i++) out.append(m_hist[i]);
+    return out;
+}
+
+void FrameStats::sample() {
+    if (! m_stats) return;
+    const double secs = std::max<qint64>(1, m_clock.restart()) / 1000.0;
+
+    const quint64 frames  = m_stats->frames.load();
+    const quint64 redraws = m_stats->redraws.load();
+    m_fps                 = (frames - m_last_frames) / secs;
+    m_redraw_rate         = (redraws - m_last_redraws) / secs;
+    m_last_frames         = frames;
+    m_last_redraws        = redraws;
+
+    const quint64 wakeups = mpv::FrameClock::Instance()->wakeups();
+    m_clock_wakeups       = (wakeups - m_last_wakeups) / secs;
+    m_last_wakeups        = wakeups;
+
+    quint64 count { 0 };
+    for (int i = 0; i < mpv::RenderStats::Buckets; i++) {
+        const quint32 cur = m_stats->histogram[i].load(std::memory_order_relaxed);
+        m_hist[i]         = cur - m_last_hist[i];
+        m_last_hist[i]    = cur;
+        count += m_hist[i];
+    }
+    const qint64 sum  = m_stats->sum_ns.load();
+    const qint64 slow = m_stats->slow_ns.load();
+    m_mean_ms         = count ? (sum - m_last_sum) / (double)count / 1e6 : 0;
+    // from this reader's deltas, a shared max would be reset by every other reader
+    int top = mpv::RenderStats::Buckets - 1;
+    while (top >= 0 && m_hist[top] == 0) top--;
+    if (top < 0)
+        m_max_ms = 0;
+    else if (top == mpv::RenderStats::Buckets - 1)
+        m_max_ms = (slow - m_last_slow) / (double)m_hist[top] / 1e6;
+    else
+        m_max_ms = (top + 1) * mpv::RenderStats::BucketNs / 1e6;
+    m_last_sum  = sum;
+    m_last_slow = slow;
+
+    // upper edge of the bucket holding the rank, the open last bucket reports max
+    auto percentile = [&](double p) -> double {
+        if (! count) return 0;
+        const quint64 rank = std::max<quint64>(1, quint64(p * count + 0.5));
+        quint64       seen { 0 };
+        for (int i = 0; i < mpv::RenderStats::Buckets - 1; i++) {
+            seen += m_hist[i];
+            if (seen >= rank)
+                return std::min(m_max_ms, (i + 1) * mpv::RenderStats::BucketNs / 1e6);
+        }
+        return m_max_ms;
+    };
+    m_p50_ms = percentile(0.50);
+    m_p95_ms = percentile(0.95);
+    m_p99_ms = percentile(0.99);
+
+    QVariantMap counters;
+    int         startup_ms { -1 };
+    if (auto* mpv = qobject_cast<mpv::MpvObject*>(m_target.data())) {
+        counters   = mpv->playbackCounters();
+        startup_ms = mpv->startupMs();
+    }
+    m_dropped = counters.value("frame-drop-count").toLongLong() +
+                counters.value("decoder-frame-drop-count").toLongLong();
+    m_delayed             = counters.value("vo-delayed-frame-count").toLongLong();
+    const auto cache      = counters.value("demuxer-cache-state").toMap();
+    m_cache_seconds       = cache.value("cache-duration").toDouble();
+    m_cache_bytes         = cache.value("fw-bytes").toLongLong();
+    m_texture_bytes       = m_stats->texture_bytes.load();
+    m_rss_kib             = RssKiB();
+
+    m_snapshot = QVariantMap {
+        { "backend", m_backend },
+        { "interval_ms", qRound(secs * 1000) },
+        { "fps", m_fps },
+        { "redraw_rate", m_redraw_rate },
+        { "render",
+          QVariantMap {
+              { "count", count },
+              { "mean_ms", m_mean_ms },
+              { "p50_ms", m_p50_ms },
+              { "p95_ms", m_p95_ms },
+              { "p99_ms", m_p99_ms },
+              { "max_ms", m_max_ms },
+              { "bucket_ms", mpv::RenderStats::BucketNs / 1e6 },
+              { "histogram", histogram() },
+          } },
+        { "dropped_frames", m_dropped },
+        { "delayed_frames", m_delayed },
+        { "estimated_vf_fps", counters.value("estimated-vf-fps") },
+        { "cache_seconds", m_cache_seconds },
+        { "cache_bytes", m_cache_bytes },
+        { "texture_bytes", m_texture_bytes },
+        { "rss_kib", m_rss_kib },
+        { "clock_wakeups_per_s", m_clock_wakeups },
+        // creation to first frame, mpv only
+        { "startup_ms", startup_ms },
+    };
+    m_json = QString::fromUtf8(QJsonDocument::fromVariant(m_snapshot).toJson(QJsonDocument::Compact));
+    qCDebug(wekdeStats).noquote() << m_json;
+    Q_EMIT updated();
+}
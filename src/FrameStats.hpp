@@ -0,0 +1,134 @@
+#pragma once
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QQuickItem>
+#include <array>
+#include <memory>
+
+#include "MpvBackend.hpp"
+
+namespace wekde
+{
+
+// frame statistics of one wallpaper backend item, Mpv or SceneViewer
+// nothing is collected while inactive, the renderer only bumps two counters
+class FrameStats : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QQuickItem* target READ target WRITE setTarget NOTIFY targetChanged)
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    // ms between snapshots
+    Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+
+    Q_PROPERTY(QString backend READ backend NOTIFY updated)
+    Q_PROPERTY(double fps READ fps NOTIFY updated)
+    Q_PROPERTY(double redrawRate READ redrawRate NOTIFY updated)
+    Q_PROPERTY(double renderMeanMs READ renderMeanMs NOTIFY updated)
+    Q_PROPERTY(double renderP50Ms READ renderP50Ms NOTIFY updated)
+    Q_PROPERTY(double renderP95Ms READ renderP95Ms NOTIFY updated)
+    Q_PROPERTY(double renderP99Ms READ renderP99Ms NOTIFY updated)
+    // upper edge of the slowest bucket, mean of the open last bucket when frames land there
+    Q_PROPERTY(double renderMaxMs READ renderMaxMs NOTIFY updated)
+    // render time histogram of the last interval, 0.125ms per bucket
+    Q_PROPERTY(QVariantList histogram READ histogram NOTIFY updated)
+    Q_PROPERTY(qint64 droppedFrames READ droppedFrames NOTIFY updated)
+    Q_PROPERTY(qint64 delayedFrames READ delayedFrames NOTIFY updated)
+    Q_PROPERTY(double cacheSeconds READ cacheSeconds NOTIFY updated)
+    Q_PROPERTY(qint64 cacheBytes READ cacheBytes NOTIFY updated)
+    Q_PROPERTY(qint64 textureBytes READ textureBytes NOTIFY updated)
+    // whole process, instances share it
+    Q_PROPERTY(qint64 rssKiB READ rssKiB NOTIFY updated)
+    // wakeups per second of the frame clock that paces all mpv instances
+    Q_PROPERTY(double clockWakeups READ clockWakeups NOTIFY updated)
+    Q_PROPERTY(QString json READ json NOTIFY updated)
+
+public:
+    FrameStats(QObject* parent = nullptr);
+    virtual ~FrameStats();
+
+    QQuickItem* target() const { return m_target; }
+    bool        active() const { return m_active; }
+    int         interval() const { return m_timer.interval(); }
+    void        setTarget(QQuickItem*);
+    void        setActive(bool);
+    void        setInterval(int);
+    // mpv cache state and vf fps, observed only while some reader wants them
+    bool        detail() const { return m_detail; }
+    void        setDetail(bool);
+
+    QString      backend() const { return m_backend; }
+    double       fps() const { return m_fps; }
+    double       redrawRate() const { return m_redraw_rate; }
+    double       renderMeanMs() const { return m_mean_ms; }
+    double       renderP50Ms() const { return m_p50_ms; }
+    double       renderP95Ms() const { return m_p95_ms; }
+    double       renderP99Ms() const { return m_p99_ms; }
+    double       renderMaxMs() const { return m_max_ms; }
+    QVariantList histogram() const;
+    qint64       droppedFrames() const { return m_dropped; }
+    qint64       delayedFrames() const { return m_delayed; }
+    double       cacheSeconds() const { return m_cache_seconds; }
+    qint64       cacheBytes() const { return m_cache_bytes; }
+    qint64       textureBytes() const { return m_texture_bytes; }
+    qint64       rssKiB() const { return m_rss_kib; }
+    double       clockWakeups() const { return m_clock_wakeups; }
+    QString      json() const { return m_json; }
+
+    Q_INVOKABLE QVariantMap snapshot() const { return m_snapshot; }
+
+signals:
+    void targetChanged();
+    void activeChanged();
+    void intervalChanged();
+    void updated();
+
+private slots:
+    void sample();
+
+private:
+    void attach();
+    void detach();
+    void reset();
+
+    QPointer<QQuickItem> m_target;
+    bool                 m_active { true };
+    QTimer               m_timer;
+    QElapsedTimer        m_clock;
+
+    bool                              m_detail { true };
+    QPointer<mpv::MpvObject>          m_watched;
+    QString                           m_backend;
+    std::shared_ptr<mpv::RenderStats> m_stats;
+    QMetaObject::Connection           m_before;
+    QMetaObject::Connection           m_after;
+    QMetaObject::Connection           m_window;
+
+    quint64                   m_last_frames { 0 };
+    quint64                   m_last_redraws { 0 };
+    using Histogram = std::array<quint32, mpv::RenderStats::Buckets>;
+    Histogram                 m_last_hist {};
+    Histogram                 m_hist {};
+    qint64                    m_last_sum { 0 };
+    qint64                    m_last_slow { 0 };
+    quint64                   m_last_wakeups { 0 };
+
+    double      m_fps { 0 };
+    double      m_redraw_rate { 0 };
+    double      m_mean_ms { 0 };
+    double      m_p50_ms { 0 };
+    double      m_p95_ms { 0 };
+    double      m_p99_ms { 0 };
+    double      m_max_ms { 0 };
+    qint64      m_dropped { 0 };
+    qint64      m_delayed { 0 };
+    double      m_cache_seconds { 0 };
+    qint64      m_cache_bytes { 0 };
+    qint64      m_texture_bytes { 0 };
+    qint64      m_rss_kib { 0 };
+    double      m_clock_wakeups { 0 };
+    QVariantMap m_snapshot;
+    QString     m_json;
+};
+} // namespace wekde
@@ -0,0 +1,158 @@
+#include "LibraryWatcher.hpp"
+#include <QLoggingCategory>
+#include <QSocketNotifier>
+#include <QFile>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <climits>
+
+Q_DECLARE_LOGGING_CATEGORY(wekdeLibrary)
+
+using namespace wekde;
+
+namespace
+{
+constexpr uint32_t RootMask { IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF |
+                              IN_MOVE_SELF | IN_ONLYDIR };
+constexpr uint32_t ItemMask { IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                              IN_ONLYDIR };
+constexpr int      DefaultDebounce { 500 };
+} // namespace
+
+LibraryWatcher::LibraryWatcher(QObject* parent): QObject(parent) {
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0) {
+        qCWarning(wekdeLibrary) << "inotify not available, library updates need manual refresh";
+        return;
+    }
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &LibraryWatcher::onReadable);
+
+    m_debounce.setSingleShot(true);
+    m_debounce.setInterval(DefaultDebounce);
+    connect(&m_debounce, &QTimer::timeout, this, &LibraryWatcher::flush);
+}
+
+LibraryWatcher::~LibraryWatcher() {
+    if (m_fd >= 0) ::close(m_fd);
+}
+
+void LibraryWatcher::clear() {
+    for (auto wd : m_wds) inotify_rm_watch(m_fd, wd);
+    m_roots.clear();
+    m_items.clear();
+    m_wds.clear();
+    m_pending.clear();
+    m_debounce.stop();
+}
+
+void LibraryWatcher::setDirs(const QStringList& roots, const QStringList& items) {
+    if (! valid()) return;
+    // only the difference, a watch dropped and added again misses what happens in between
+    const QSet<QString> want_roots(roots.begin(), roots.end());
+    const QSet<QString> want_items(items.begin(), items.end());
+    for (auto it = m_roots.begin(); it != m_roots.end();) {
+        if (want_roots.contains(it.value())) {
+            ++it;
+            continue;
+        }
+        inotify_rm_watch(m_fd, it.key());
+        m_wds.remove(it.value());
+        it = m_roots.erase(it);
+    }
+    for (auto it = m_items.begin(); it != m_items.end();) {
+        if (want_items.contains(it.value()) && ! want_roots.contains(it.value())) {
+            ++it;
+            continue;
+        }
+        inotify_rm_watch(m_fd, it.key());
+        m_wds.remove(it.value());
+        it = m_items.erase(it);
+    }
+    for (auto& r : roots) addRoot(r);
+    for (auto& i : items) addItem(i);
+}
+
+void LibraryWatcher::addRoot(const QString& path) {
+    if (m_wds.contains(path)) return;
+    int wd = inotify_add_watch(m_fd, QFile::encodeName(path).constData(), RootMask);
+    if (wd < 0) return;
+    m_roots.insert(wd, path);
+    m_wds.insert(path, wd);
+}
+
+void LibraryWatcher::addItem(const QString& path) {
+    if (m_wds.contains(path)) return;
+    int wd = inotify_add_watch(m_fd, QFile::encodeName(path).constData(), ItemMask);
+    if (wd < 0) {
+        // usually ENOSPC from max_user_watches, root watch still catches add/remove
+        return;
+    }
+    m_items.insert(wd, path);
+    m_wds.insert(path, wd);
+}
+
+void LibraryWatcher::removeWatch(int wd) {
+    QString path = m_items.take(wd);
+    if (path.isEmpty()) path = m_roots.take(wd);
+    if (! path.isEmpty()) m_wds.remove(path);
+}
+
+void LibraryWatcher::markDirty(const QString& item) {
+    if (m_pending.isEmpty()) m_burst.start();
+    m_pending.insert(item);
+    // keep restarting while events arrive, but don't starve on a long copy
+    if (m_burst.elapsed() > 4 * m_debounce.interval())
+        flush();
+    else
+        m_debounce.start();
+}
+
+void LibraryWatcher::onReadable() {
+    alignas(struct inotify_event) char buf[4096];
+    bool                               need_rescan { false };
+    for (;;) {
+        ssize_t len = ::read(m_fd, buf, sizeof(buf));
+        if (len <= 0) break;
+        for (char* ptr = buf; ptr < buf + len;) {
+            auto* ev = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW) {
+                need_rescan = true;
+                continue;
+            }
+            if (ev->mask & IN_IGNORED) {
+                removeWatch(ev->wd);
+                continue;
+            }
+            const QString name = ev->len ? QFile::decodeName(ev->name) : QString();
+            if (auto it = m_roots.constFind(ev->wd); it != m_roots.cend()) {
+                if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                    need_rescan = true;
+                    continue;
+                }
+                if (name.isEmpty() || ! (ev->mask & IN_ISDIR)) continue;
+                const QString item = it.value() + '/' + name;
+                if (ev->mask & (IN_CREATE | IN_MOVED_TO)) addItem(item);
+                markDirty(item);
+            } else if (auto it = m_items.constFind(ev->wd); it != m_items.cend()) {
+                if (name == "project.json") markDirty(it.value());
+            }
+        }
+    }
+    if (need_rescan) {
+        m_pending.clear();
+        m_debounce.stop();
+        Q_EMIT overflow();
+    }
+}
+
+void LibraryWatcher::flush() {
+    m_debounce.stop();
+    if (m_pending.isEmpty()) return;
+    QStringList items(m_pending.begin(), m_pending.end());
+    m_pending.clear();
+    Q_EMIT dirty(items);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QSocketNotifier;
+
+namespace wekde
+{
+
+// inotify watcher for wallpaper roots and their item folders
+// events are debounced and coalesced into one dirty list of item folders
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+public:
+    LibraryWatcher(QObject* parent = nullptr);
+    virtual ~LibraryWatcher();
+
+    bool valid() const { return m_fd >= 0; }
+
+    // watch exactly these, watches already in place are kept and pending events survive
+    void setDirs(const QStringList& roots, const QStringList& items);
+    void clear();
+
+    // quiet time before flush, a burst is never held longer than 4x of it
+    void setDebounce(int ms) { m_debounce.setInterval(ms); }
+
+signals:
+    // item folders which were created, removed or had project.json changed
+    void dirty(const QStringList& items);
+    // kernel queue overflowed or a root went away, need full rescan
+    void overflow();
+
+private:
+    void onReadable();
+    void flush();
+    void markDirty(const QString& item);
+    void addRoot(const QString& path);
+    void addItem(const QString& path);
+    void removeWatch(int wd);
+
+    int              m_fd { -1 };
+    QSocketNotifier* m_notifier { nullptr };
+
+    QHash<int, QString> m_roots; // wd -> path
+    QHash<int, QString> m_items; // wd -> path
+    QHash<QString, int> m_wds;   // path -> wd
+
+    QSet<QString> m_pending;
+    QTimer        m_debounce;
+    QElapsedTimer m_burst;
+};
+} // namespace wekde
@@ -4,12 +4,26 @@
 #include <QCoreApplication>
 #include <QHoverEvent>
 #include <QMouseEvent>
+#include <QQuickWindow>
+
+Q_LOGGING_CATEGORY(wekdeMouse, "wekde.mouse")
+
+namespace
+{
+constexpr int DefaultFps { 60 };
+} // namespace
 
 using namespace wekde;
 
 MouseGrabber::MouseGrabber(QQuickItem* parent): QQuickItem(parent) {
     setAcceptedMouseButtons(Qt::LeftButton);
     setAcceptHoverEvents(true);
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &MouseGrabber::flush);
+}
+
+MouseGrabber::~MouseGrabber() {
+    qCDebug(wekdeMouse) << "delivered" << m_delivered << "coalesced" << m_coalesced;
 }
 
 bool MouseGrabber::forceCapture() const { return m_forceCapture; }
@@ -34,6 +48,22 @@ void MouseGrabber::setTarget(QQuickItem* item) {
     Q_EMIT targetChanged();
 }
 
+void MouseGrabber::setFps(int value) {
+    if (value == m_fps) return;
+    m_fps = value;
+    Q_EMIT fpsChanged();
+}
+
+void MouseGrabber::itemChange(ItemChange change, const ItemChangeData& value) {
+    if (change == ItemSceneChange) {
+        disconnect(m_frame);
+        // gui thread, right before the scene graph syncs
+        if (value.window)
+            m_frame = connect(value.window, &QQuickWindow::afterAnimating, this, &MouseGrabber::flush);
+    }
+    QQuickItem::itemChange(change, value);
+}
+
 void MouseGrabber::mouseUngrabEvent() {
     if (m_forceCapture) grabMouse();
 }
@@ -43,6 +73,8 @@ void MouseGrabber::sendEvent(QObject* target, QEvent* event) {
 }
 
 void MouseGrabber::sendMouseEvent(QMouseEvent* event) {
+    // press and release after the moves before them
+    flush();
     if (m_target) {
         QMouseEvent temp(event->type(),
                          mapToItem(m_target, event->localPos()),
@@ -51,17 +83,64 @@ void MouseGrabber::sendMouseEvent(QMouseEvent* event) {
                          event->buttons(),
                          event->modifiers());
         QCoreApplication::sendEvent(m_target, &temp);
+        m_delivered++;
     }
 }
 
-void MouseGrabber::sendHoverEvent(QHoverEvent* event) {
+void MouseGrabber::queueMove(QMouseEvent* event) {
+    if (! m_target) return;
+    if (m_move.valid) m_coalesced++;
+    m_move = { true, event->position(), event->globalPosition(), event->buttons(), event->modifiers() };
+    schedule();
+}
+
+void MouseGrabber::queueHover(QHoverEvent* event) {
+    if (! m_target) return;
+    if (m_hover.valid) {
+        m_coalesced++;
+        m_hover.pos       = event->position();
+        m_hover.modifiers = event->modifiers();
+    } else {
+        m_hover = { true, event->position(), event->oldPosF(), event->modifiers() };
+    }
+    schedule();
+}
+
+void MouseGrabber::schedule() {
+    if (! window()) {
+        flush();
+        return;
+    }
+    // a frame coming anyway flushes on afterAnimating, no redraw is forced for a move
+    if (! m_timer.isActive()) m_timer.start(1000 / (m_fps > 0 ? m_fps : DefaultFps));
+}
+
+void MouseGrabber::flush() {
+    m_timer.stop();
+    if (! m_move.valid && ! m_hover.valid) return;
     if (m_target) {
-        QHoverEvent temp(event->type(),
-                         mapToItem(m_target, event->posF()),
-                         mapToItem(m_target, event->oldPosF()),
-                         event->modifiers());
-        QCoreApplication::sendEvent(m_target, &temp);
+        if (m_move.valid) {
+            QMouseEvent temp(QEvent::MouseMove,
+                             mapToItem(m_target, m_move.pos),
+                             m_move.global,
+                             Qt::NoButton,
+                             m_move.buttons,
+                             m_move.modifiers);
+            QCoreApplication::sendEvent(m_target, &temp);
+            m_delivered++;
+        }
+        if (m_hover.valid) {
+            QHoverEvent temp(QEvent::HoverMove,
+                             mapToItem(m_target, m_hover.pos),
+                             mapToItem(m_target, m_hover.old),
+                             m_hover.modifiers);
+            QCoreApplication::sendEvent(m_target, &temp);
+            m_delivered++;
+        }
     }
+    m_move.valid  = false;
+    m_hover.valid = false;
+    Q_EMIT statsChanged();
 }
 
 void MouseGrabber::mousePressEvent(QMouseEvent* event) {
@@ -72,7 +151,7 @@ void MouseGrabber::mousePressEvent(QMouseEvent* event) {
 }
 
 void MouseGrabber::mouseMoveEvent(QMouseEvent* event) {
-    sendMouseEvent(event);
+    queueMove(event);
     event->ignore();
 }
 
@@ -87,6 +166,6 @@ void MouseGrabber::mouseDoubleClickEvent(QMouseEvent* event) {
 }
 
 void MouseGrabber::hoverMoveEvent(QHoverEvent* event) {
-    sendHoverEvent(event);
+    queueHover(event);
     event->ignore();
 }
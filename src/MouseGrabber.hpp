@@ -4,6 +4,7 @@
 #include <QMouseEvent>
 #include <QHoverEvent>
 #include <QPointer>
+#include <QTimer>
 
 namespace wekde
 {
@@ -13,20 +14,30 @@ class MouseGrabber : public QQuickItem
     Q_OBJECT
 	Q_PROPERTY(bool forceCapture READ forceCapture WRITE setForceCapture NOTIFY forceCaptureChanged)
 	Q_PROPERTY(QQuickItem* target READ target WRITE setTarget NOTIFY targetChanged)
+	// moves wait at most one frame of target at this rate when the window draws nothing
+	Q_PROPERTY(int fps READ fps WRITE setFps NOTIFY fpsChanged)
+	// events sent to target, and moves merged into a later one
+	Q_PROPERTY(qint64 delivered READ delivered NOTIFY statsChanged)
+	Q_PROPERTY(qint64 coalesced READ coalesced NOTIFY statsChanged)
 
 public:
 	MouseGrabber(QQuickItem *parent = nullptr);
-	virtual ~MouseGrabber() override {};
+	virtual ~MouseGrabber() override;
 
 	bool forceCapture() const;
 	QQuickItem* target() const; 
+	int fps() const { return m_fps; }
+	qint64 delivered() const { return m_delivered; }
+	qint64 coalesced() const { return m_coalesced; }
 
 	void setForceCapture(bool);
 	void setTarget(QQuickItem*);
+	void setFps(int);
 
 	Q_INVOKABLE void sendEvent(QObject*, QEvent*);
 
 protected:
+	void itemChange(ItemChange, const ItemChangeData&) override;
 	void mouseUngrabEvent() override;
 	void mousePressEvent(QMouseEvent*) override;
 	void mouseMoveEvent(QMouseEvent*) override;
@@ -37,11 +48,37 @@ protected:
 signals:
 	void forceCaptureChanged();
 	void targetChanged();
+	void fpsChanged();
+	void statsChanged();
 
 private:
     void sendMouseEvent(QMouseEvent*);
-    void sendHoverEvent(QHoverEvent*);
+    // moves wait for a frame, or one frame at fps, only the latest position is sent
+    void queueMove(QMouseEvent*);
+    void queueHover(QHoverEvent*);
+    void schedule();
+    void flush();
 	bool m_forceCapture {false};
     QPointer<QQuickItem> m_target {nullptr};
+    QMetaObject::Connection m_frame;
+    int m_fps {0};
+    QTimer m_timer;
+
+    struct PendingMove {
+        bool valid {false};
+        QPointF pos;
+        QPointF global;
+        Qt::MouseButtons buttons;
+        Qt::KeyboardModifiers modifiers;
+    } m_move;
+    struct PendingHover {
+        bool valid {false};
+        QPointF pos;
+        // from the first merged event, target sees one continuous move
+        QPointF old;
+        Qt::KeyboardModifiers modifiers;
+    } m_hover;
+    qint64 m_delivered {0};
+    qint64 m_coalesced {0};
 };
 }
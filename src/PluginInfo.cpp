@@ -11,7 +11,8 @@ PluginInfo::PluginInfo(QObject* parent): QObject(parent) {}
 
 PluginInfo::~PluginInfo() {}
 
-QUrl PluginInfo::cache_path() const {
-    return QUrl::fromLocalFile(
-        QString::fromStdString(scenebackend::SceneObject::GetDefaultCachePath()));
+QUrl PluginInfo::cache_path() const { return QUrl::fromLocalFile(cacheDir()); }
+
+QString PluginInfo::cacheDir() {
+    return QString::fromStdString(scenebackend::SceneObject::GetDefaultCachePath());
 }
@@ -16,6 +16,9 @@ public:
 
     QUrl cache_path() const;
 
+    // local path of cache_path, for native users
+    static QString cacheDir();
+
     QString version() const { return "0.5.5"; };
 
 protected:
@@ -0,0 +1,205 @@
+#include "QualityGovernor.hpp"
+#include "FrameStats.hpp"
+#include "FrameClock.hpp"
+
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QQuickWindow>
+#include <QScreen>
+
+#include <array>
+#include <cstdio>
+
+Q_LOGGING_CATEGORY(wekdeGovernor, "wekde.governor")
+
+using namespace wekde;
+
+namespace
+{
+struct Tier {
+    // share of the reference rate
+    double fps;
+    double scale;
+    bool   decode;
+};
+constexpr std::array<Tier, 4> Tiers { {
+    { 1.0, 1.0, false },
+    { 0.5, 1.0, false },
+    { 0.5, 0.75, false },
+    { 0.4, 0.5, true },
+} };
+constexpr int MinFps { 5 };
+
+// samples, one per second
+constexpr int DownAfter { 3 };
+constexpr int UpAfter { 10 };
+constexpr int MaxUpAfter { 160 };
+constexpr int Hold { 5 };
+// a step down this soon after a step up doubles the wait for the next one
+constexpr int Backoff { 60 };
+
+// share of one core spent in the render path
+constexpr double HeavyBusy { 0.25 };
+constexpr double LightBusy { 0.10 };
+// band of whole system load where nothing changes
+constexpr double HeavyLoad { 0.85 };
+constexpr double LightLoad { 0.60 };
+
+// busy share of all cpus since the last call, shared by all instances
+double SystemLoad() {
+    static QElapsedTimer clock;
+    static quint64       last_busy { 0 }, last_total { 0 };
+    static double        load { 0 };
+    if (clock.isValid() && clock.elapsed() < 500) return load;
+    clock.start();
+
+    unsigned long long v[8] {};
+    FILE*              f = std::fopen("/proc/stat", "r");
+    if (! f) return load;
+    const int n = std::fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu", &v[0], &v[1], &v[2],
+                              &v[3], &v[4], &v[5], &v[6], &v[7]);
+    std::fclose(f);
+    if (n < 4) return load;
+
+    quint64 total { 0 };
+    for (auto x : v) total += x;
+    // idle and iowait
+    const quint64 busy = total - v[3] - v[4];
+    if (last_total && total > last_total)
+        load = double(busy - last_busy) / double(total - last_total);
+    last_busy  = busy;
+    last_total = total;
+    return load;
+}
+} // namespace
+
+QualityGovernor::QualityGovernor(QObject* parent)
+    : QObject(parent), m_stats(new FrameStats(this)), m_up_after(UpAfter), m_since_up(Backoff) {
+    // only timings and drops are needed
+    m_stats->setDetail(false);
+    connect(m_stats, &FrameStats::updated, this, &QualityGovernor::evaluate);
+}
+
+QualityGovernor::~QualityGovernor() = default;
+
+void QualityGovernor::setTarget(QQuickItem* target) {
+    if (target == m_target) return;
+    m_target = target;
+    m_stats->setTarget(target);
+    reset();
+    Q_EMIT targetChanged();
+}
+
+void QualityGovernor::setActive(bool v) {
+    if (v == m_active) return;
+    m_active = v;
+    m_stats->setActive(v);
+    reset();
+    Q_EMIT activeChanged();
+}
+
+void QualityGovernor::setBaseFps(int v) {
+    v = std::max(0, v);
+    if (v == m_base_fps) return;
+    m_base_fps = v;
+    Q_EMIT baseFpsChanged();
+    Q_EMIT tierChanged();
+}
+
+int QualityGovernor::fps() const {
+    if (m_tier == 0) return m_base_fps;
+    // drawn rate at full quality stands in for the source rate of a video
+    int ref = m_base_fps > 0 ? m_base_fps : m_ref_fps;
+    if (ref <= 0) ref = refreshRate();
+    // a whole divisor of the refresh keeps frame pacing even on the shared clock
+    return mpv::FrameClock::Divide(std::max(MinFps, qRound(ref * Tiers[m_tier].fps)),
+                                   refreshRate());
+}
+
+double QualityGovernor::renderScale() const { return Tiers[m_tier].scale; }
+
+bool QualityGovernor::decodeDownscale() const { return Tiers[m_tier].decode; }
+
+int QualityGovernor::refreshRate() const {
+    if (m_target && m_target->window() && m_target->window()->screen())
+        return std::max(1, qRound(m_target->window()->screen()->refreshRate()));
+    return 60;
+}
+
+void QualityGovernor::reset() {
+    m_heavy        = 0;
+    m_light        = 0;
+    m_hold         = 0;
+    m_since_up     = Backoff;
+    m_up_after     = UpAfter;
+    m_last_dropped = -1;
+    m_ref_fps      = 0;
+    if (m_tier != 0) {
+        m_tier = 0;
+        Q_EMIT tierChanged();
+    }
+}
+
+void QualityGovernor::setTier(int v, const char* why) {
+    if (v > m_tier && m_since_up < Backoff) m_up_after = std::min(MaxUpAfter, m_up_after * 2);
+    if (v < m_tier) m_since_up = 0;
+    if (v == 0) m_up_after = UpAfter;
+
+    qCDebug(wekdeGovernor) << m_stats->backend() << "tier" << m_tier << "->" << v << why
+                           << "fps" << m_stats->fps() << "render mean" << m_stats->renderMeanMs()
+                           << "p95" << m_stats->renderP95Ms() << "load" << m_load << "next up after"
+                           << m_up_after;
+    m_tier  = v;
+    m_heavy = 0;
+    m_light = 0;
+    m_hold  = Hold;
+    Q_EMIT tierChanged();
+}
+
+void QualityGovernor::evaluate() {
+    if (! m_active || ! m_target) return;
+    m_load = SystemLoad();
+    Q_EMIT sampled();
+    m_since_up++;
+
+    const double fps    = m_stats->fps();
+    const double budget = 1000.0 / refreshRate();
+    const double busy   = fps * m_stats->renderMeanMs() / 1000.0;
+    const double p95    = m_stats->renderP95Ms();
+    const qint64 total  = m_stats->droppedFrames();
+    // under an fps cap mpv also counts the frames skipped on purpose
+    const qint64 drops = m_tier == 0 && m_last_dropped >= 0 && total >= m_last_dropped
+                             ? total - m_last_dropped
+                             : 0;
+    m_last_dropped     = total;
+    if (m_tier == 0 && fps >= MinFps) m_ref_fps = qRound(fps);
+
+    if (m_hold > 0) {
+        m_hold--;
+        return;
+    }
+
+    const char* heavy = nullptr;
+    if (drops > std::max(2.0, fps * 0.05))
+        heavy = "dropping frames";
+    else if (p95 > budget)
+        heavy = "slow frames";
+    else if (busy > HeavyBusy)
+        heavy = "render time";
+    else if (m_load > HeavyLoad)
+        heavy = "system load";
+    const bool light =
+        ! heavy && drops == 0 && p95 < budget / 2 && busy < LightBusy && m_load < LightLoad;
+
+    if (heavy) {
+        m_light = 0;
+        if (++m_heavy >= DownAfter && m_tier + 1 < (int)Tiers.size()) setTier(m_tier + 1, heavy);
+    } else if (light) {
+        m_heavy = 0;
+        if (++m_light >= m_up_after && m_tier > 0) setTier(m_tier - 1, "light");
+    } else {
+        // inside the band, stay
+        m_heavy = 0;
+        m_light = 0;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <QObject>
+#include <QPointer>
+#include <QQuickItem>
+
+namespace wekde
+{
+
+class FrameStats;
+
+// steps one wallpaper through quality tiers by its render time, dropped frames and system load
+// outputs are bound by the backend qml: fps for both, renderScale and decodeDownscale for Mpv
+// a tier is only left after the load has been clearly above or below it for a while
+class QualityGovernor : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QQuickItem* target READ target WRITE setTarget NOTIFY targetChanged)
+    // off keeps tier 0
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+    // configured rate, 0 for the source rate of a video
+    Q_PROPERTY(int baseFps READ baseFps WRITE setBaseFps NOTIFY baseFpsChanged)
+
+    // 0 is full quality
+    Q_PROPERTY(int tier READ tier NOTIFY tierChanged)
+    // baseFps in tier 0, 0 still means the source rate
+    Q_PROPERTY(int fps READ fps NOTIFY tierChanged)
+    Q_PROPERTY(double renderScale READ renderScale NOTIFY tierChanged)
+    Q_PROPERTY(bool decodeDownscale READ decodeDownscale NOTIFY tierChanged)
+    // busy share of all cpus over the last interval
+    Q_PROPERTY(double systemLoad READ systemLoad NOTIFY sampled)
+
+public:
+    QualityGovernor(QObject* parent = nullptr);
+    virtual ~QualityGovernor();
+
+    QQuickItem* target() const { return m_target; }
+    bool        active() const { return m_active; }
+    int         baseFps() const { return m_base_fps; }
+    void        setTarget(QQuickItem*);
+    void        setActive(bool);
+    void        setBaseFps(int);
+
+    int    tier() const { return m_tier; }
+    int    fps() const;
+    double renderScale() const;
+    bool   decodeDownscale() const;
+    double systemLoad() const { return m_load; }
+
+signals:
+    void targetChanged();
+    void activeChanged();
+    void baseFpsChanged();
+    void tierChanged();
+    void sampled();
+
+private slots:
+    void evaluate();
+
+private:
+    void setTier(int, const char* why);
+    void reset();
+    // refresh rate of the target's screen, 60 without one
+    int  refreshRate() const;
+
+    QPointer<QQuickItem> m_target;
+    bool                 m_active { true };
+    int                  m_base_fps { 0 };
+    FrameStats*          m_stats { nullptr };
+
+    int    m_tier { 0 };
+    double m_load { 0 };
+    qint64 m_last_dropped { -1 };
+    // drawn fps at tier 0
+    int    m_ref_fps { 0 };
+
+    // consecutive samples above and below the band
+    int m_heavy { 0 };
+    int m_light { 0 };
+    // samples left before another step
+    int m_hold { 0 };
+    // light samples needed for a step up, doubled when a step up is soon taken back
+    int m_up_after;
+    int m_since_up;
+};
+} // namespace wekde
@@ -0,0 +1,276 @@
+#include "SessionMonitor.hpp"
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <QDBusArgument>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusObjectPath>
+#include <QDBusVariant>
+
+Q_LOGGING_CATEGORY(wekdeSession, "wekde.session")
+
+using namespace wekde;
+
+namespace
+{
+constexpr const char* Login1 { "org.freedesktop.login1" };
+constexpr const char* Login1Path { "/org/freedesktop/login1" };
+constexpr const char* Login1Manager { "org.freedesktop.login1.Manager" };
+constexpr const char* Login1Session { "org.freedesktop.login1.Session" };
+constexpr const char* Login1User { "org.freedesktop.login1.User" };
+constexpr const char* Login1UserSelf { "/org/freedesktop/login1/user/self" };
+constexpr const char* UPower { "org.freedesktop.UPower" };
+constexpr const char* UPowerPath { "/org/freedesktop/UPower" };
+constexpr const char* UPowerDevice { "org.freedesktop.UPower.Device" };
+constexpr const char* UPowerDisplayPath { "/org/freedesktop/UPower/devices/DisplayDevice" };
+constexpr const char* ScreenSaver { "org.freedesktop.ScreenSaver" };
+constexpr const char* ScreenSaverPath { "/org/freedesktop/ScreenSaver" };
+constexpr const char* Properties { "org.freedesktop.DBus.Properties" };
+
+// power-profiles-daemon moved to the upower namespace in 0.20, keep the old one too
+struct ProfileService {
+    const char* name;
+    const char* path;
+};
+constexpr ProfileService ProfileServices[] {
+    { "org.freedesktop.UPower.PowerProfiles", "/org/freedesktop/UPower/PowerProfiles" },
+    { "net.hadess.PowerProfiles", "/net/hadess/PowerProfiles" },
+};
+
+// upower device type of a battery
+constexpr uint UPowerBattery { 2 };
+
+QDBusConnection Bus(QDBusConnection::BusType type, const char* env, bool* standin) {
+    const QByteArray address = qgetenv(env);
+    if (address.isEmpty()) {
+        return type == QDBusConnection::SystemBus ? QDBusConnection::systemBus()
+                                                  : QDBusConnection::sessionBus();
+    }
+    *standin = true;
+    return QDBusConnection::connectToBus(QString::fromUtf8(address), QString("wekde-") + env);
+}
+
+// object path of a GetSession* reply or of the (so) Display property, empty if none
+QString SessionPath(const QDBusMessage& reply, bool display) {
+    const QVariant arg = reply.arguments().value(0);
+    if (! display) return arg.value<QDBusObjectPath>().path();
+    const QVariant value = arg.value<QDBusVariant>().variant();
+    if (! value.canConvert<QDBusArgument>()) return {};
+    const QDBusArgument data = value.value<QDBusArgument>();
+    if (data.currentType() != QDBusArgument::StructureType) return {};
+    QString         id;
+    QDBusObjectPath path;
+    data.beginStructure();
+    data >> id >> path;
+    data.endStructure();
+    // "/" when the user has no graphical session
+    return path.path() == "/" ? QString() : path.path();
+}
+
+std::weak_ptr<SessionMonitor> Shared;
+} // namespace
+
+SessionMonitor::SessionMonitor()
+    : m_system(Bus(QDBusConnection::SystemBus, "WEKDE_DBUS_SYSTEM_ADDRESS", &m_standin)),
+      m_session(Bus(QDBusConnection::SessionBus, "WEKDE_DBUS_SESSION_ADDRESS", &m_standin)) {
+    m_notify.setSingleShot(true);
+    m_notify.setInterval(0);
+    connect(&m_notify, &QTimer::timeout, this, &SessionMonitor::changed);
+
+    if (m_system.isConnected())
+        connectSystem();
+    else
+        qCWarning(wekdeSession) << "no system bus, sleep and power state unavailable";
+    if (m_session.isConnected())
+        connectSession();
+    else
+        qCWarning(wekdeSession) << "no session bus, screensaver state unavailable";
+}
+
+SessionMonitor::~SessionMonitor() {}
+
+std::shared_ptr<SessionMonitor> SessionMonitor::Instance() {
+    auto out = Shared.lock();
+    if (! out) {
+        out    = std::shared_ptr<SessionMonitor>(new SessionMonitor());
+        Shared = out;
+    }
+    return out;
+}
+
+QString SessionMonitor::service(const QString& name) const { return m_standin ? QString() : name; }
+
+void SessionMonitor::connectSystem() {
+    if (! m_system.connect(service(Login1),
+                           Login1Path,
+                           Login1Manager,
+                           "PrepareForSleep",
+                           this,
+                           SLOT(onPrepareForSleep(bool))))
+        qCWarning(wekdeSession) << "can't watch PrepareForSleep";
+
+    m_system.connect(service(UPower),
+                     UPowerPath,
+                     Properties,
+                     "PropertiesChanged",
+                     this,
+                     SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+    m_system.connect(service(UPower),
+                     UPowerDisplayPath,
+                     Properties,
+                     "PropertiesChanged",
+                     this,
+                     SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+    fetch(m_system, UPower, UPowerPath, UPower);
+    fetch(m_system, UPower, UPowerDisplayPath, UPowerDevice);
+
+    for (const auto& ppd : ProfileServices) {
+        m_system.connect(service(ppd.name),
+                         ppd.path,
+                         Properties,
+                         "PropertiesChanged",
+                         this,
+                         SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+        fetch(m_system, ppd.name, ppd.path, ppd.name);
+    }
+
+    // signals come from the real session path, resolve it first
+    resolveSession(0);
+}
+
+void SessionMonitor::resolveSession(int step) {
+    // plasmashell may run as a user service outside the session scope, without the env id
+    // GetSessionByPID fails there too, the user's display session is then the one we show on
+    QDBusMessage msg;
+    switch (step) {
+    case 0: {
+        const QString id = qEnvironmentVariable("XDG_SESSION_ID");
+        if (id.isEmpty()) return resolveSession(step + 1);
+        msg = QDBusMessage::createMethodCall(Login1, Login1Path, Login1Manager, "GetSession");
+        msg << id;
+        break;
+    }
+    case 1:
+        msg = QDBusMessage::createMethodCall(Login1, Login1Path, Login1Manager, "GetSessionByPID");
+        msg << (uint)QCoreApplication::applicationPid();
+        break;
+    case 2:
+        msg = QDBusMessage::createMethodCall(Login1, Login1UserSelf, Properties, "Get");
+        msg << QString(Login1User) << QString("Display");
+        break;
+    default:
+        qCWarning(wekdeSession)
+            << "can't resolve the logind session, lock and active state unavailable";
+        return;
+    }
+    auto* watcher = new QDBusPendingCallWatcher(m_system.asyncCall(msg), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, step](QDBusPendingCallWatcher* w) {
+        w->deleteLater();
+        const QDBusMessage reply = w->reply();
+        const QString      path =
+            reply.type() == QDBusMessage::ReplyMessage ? SessionPath(reply, step == 2) : QString();
+        if (path.isEmpty()) {
+            qCDebug(wekdeSession) << "can't resolve session, step" << step << reply.errorMessage();
+            resolveSession(step + 1);
+            return;
+        }
+        qCDebug(wekdeSession) << "session" << path;
+        watchSession(path);
+    });
+}
+
+void SessionMonitor::watchSession(const QString& path) {
+    m_session_path = path;
+    m_system.connect(service(Login1),
+                     path,
+                     Properties,
+                     "PropertiesChanged",
+                     this,
+                     SLOT(onPropertiesChanged(QString, QVariantMap, QStringList)));
+    fetch(m_system, Login1, path, Login1Session);
+}
+
+void SessionMonitor::connectSession() {
+    if (! m_session.connect(service(ScreenSaver),
+                            ScreenSaverPath,
+                            ScreenSaver,
+                            "ActiveChanged",
+                            this,
+                            SLOT(onScreenSaverActive(bool))))
+        qCWarning(wekdeSession) << "can't watch screensaver";
+
+    auto  msg     = QDBusMessage::createMethodCall(ScreenSaver, ScreenSaverPath, ScreenSaver, "GetActive");
+    auto* watcher = new QDBusPendingCallWatcher(m_session.asyncCall(msg), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this](QDBusPendingCallWatcher* w) {
+        w->deleteLater();
+        QDBusPendingReply<bool> reply = *w;
+        if (! reply.isError()) onScreenSaverActive(reply.value());
+    });
+}
+
+void SessionMonitor::fetch(QDBusConnection bus, const QString& service, const QString& path,
+                           const QString& iface) {
+    auto msg = QDBusMessage::createMethodCall(service, path, Properties, "GetAll");
+    msg << iface;
+    auto* watcher = new QDBusPendingCallWatcher(bus.asyncCall(msg), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [this, iface](QDBusPendingCallWatcher* w) {
+        w->deleteLater();
+        QDBusPendingReply<QVariantMap> reply = *w;
+        // services that are not installed are fine
+        if (reply.isError())
+            qCDebug(wekdeSession) << iface << reply.error().message();
+        else
+            applyProperties(iface, reply.value());
+    });
+}
+
+void SessionMonitor::onPrepareForSleep(bool sleep) {
+    if (sleep == m_state.sleeping) return;
+    qCDebug(wekdeSession) << "prepare for sleep:" << sleep;
+    m_state.sleeping = sleep;
+    m_notify.start();
+}
+
+void SessionMonitor::onScreenSaverActive(bool active) {
+    if (active == m_state.screensaver) return;
+    qCDebug(wekdeSession) << "screensaver:" << active;
+    m_state.screensaver = active;
+    m_notify.start();
+}
+
+void SessionMonitor::onPropertiesChanged(const QString& iface, const QVariantMap& changed,
+                                         const QStringList&) {
+    // every session emits this interface, only follow ours
+    if (iface == Login1Session && calledFromDBus() && message().path() != m_session_path) return;
+    applyProperties(iface, changed);
+}
+
+void SessionMonitor::applyProperties(const QString& iface, const QVariantMap& props) {
+    const SessionState old = m_state;
+    if (iface == Login1Session) {
+        if (props.contains("Active")) m_state.active = props.value("Active").toBool();
+        if (props.contains("LockedHint")) m_state.locked = props.value("LockedHint").toBool();
+    } else if (iface == UPower) {
+        if (props.contains("OnBattery")) m_state.on_battery = props.value("OnBattery").toBool();
+    } else if (iface == UPowerDevice) {
+        // display device aggregates all batteries
+        const bool battery = props.value("IsPresent", true).toBool() &&
+                             props.value("Type", UPowerBattery).toUInt() == UPowerBattery;
+        if (props.contains("Percentage"))
+            m_state.battery_percent = battery ? qRound(props.value("Percentage").toDouble()) : -1;
+        else if (! battery)
+            m_state.battery_percent = -1;
+    } else {
+        for (const auto& ppd : ProfileServices) {
+            if (iface != ppd.name || ! props.contains("ActiveProfile")) continue;
+            m_state.power_profile = props.value("ActiveProfile").toString();
+        }
+    }
+    if (old.active != m_state.active || old.locked != m_state.locked ||
+        old.on_battery != m_state.on_battery || old.battery_percent != m_state.battery_percent ||
+        old.power_profile != m_state.power_profile) {
+        qCDebug(wekdeSession) << iface << props;
+        m_notify.start();
+    }
+}
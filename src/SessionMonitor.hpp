@@ -0,0 +1,71 @@
+#pragma once
+#include <QObject>
+#include <QDBusConnection>
+#include <QDBusContext>
+#include <QTimer>
+#include <QVariantMap>
+#include <memory>
+
+namespace wekde
+{
+
+// what the session and power services currently report
+struct SessionState {
+    bool    sleeping { false };
+    bool    active { true };
+    bool    locked { false };
+    bool    screensaver { false };
+    bool    on_battery { false };
+    // -1 when there is no battery
+    int     battery_percent { -1 };
+    // power-profiles-daemon, e.g. power-saver, balanced, performance
+    QString power_profile;
+};
+
+// one per process, shared by every wallpaper instance
+// listens to logind, the screensaver, upower and power-profiles-daemon,
+// a missing bus or service only leaves its part of the state at default
+//
+// WEKDE_DBUS_SYSTEM_ADDRESS and WEKDE_DBUS_SESSION_ADDRESS point it to stand-in buses,
+// signals are then accepted from any sender
+class SessionMonitor : public QObject, protected QDBusContext {
+    Q_OBJECT
+public:
+    ~SessionMonitor();
+
+    static std::shared_ptr<SessionMonitor> Instance();
+
+    const SessionState& state() const { return m_state; }
+
+signals:
+    void changed();
+
+private slots:
+    void onPrepareForSleep(bool sleep);
+    void onScreenSaverActive(bool active);
+    void onPropertiesChanged(const QString& iface, const QVariantMap& changed,
+                             const QStringList& invalidated);
+
+private:
+    SessionMonitor();
+
+    void connectSystem();
+    void connectSession();
+    // env id, then our own pid, then the user's display session
+    void resolveSession(int step);
+    void watchSession(const QString& path);
+    void fetch(QDBusConnection bus, const QString& service, const QString& path,
+               const QString& iface);
+    void applyProperties(const QString& iface, const QVariantMap& props);
+    QString service(const QString& name) const;
+
+    QDBusConnection m_system;
+    QDBusConnection m_session;
+    bool            m_standin { false };
+    QString         m_session_path;
+
+    SessionState m_state;
+    // many properties come in one burst, notify once
+    QTimer       m_notify;
+};
+} // namespace wekde
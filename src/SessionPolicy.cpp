@@ -0,0 +1,94 @@
+#include "SessionPolicy.hpp"
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(wekdeSession)
+
+using namespace wekde;
+
+SessionPolicy::SessionPolicy(QObject* parent)
+    : QObject(parent), m_monitor(SessionMonitor::Instance()) {
+    m_unload.setSingleShot(true);
+    connect(&m_unload, &QTimer::timeout, this, [this]() {
+        m_unloaded = true;
+        update();
+    });
+    connect(m_monitor.get(), &SessionMonitor::changed, this, [this]() {
+        Q_EMIT stateChanged();
+        update();
+    });
+    update();
+}
+
+SessionPolicy::~SessionPolicy() {}
+
+void SessionPolicy::setBatteryPolicy(Policy v) {
+    if (v == m_battery_policy) return;
+    m_battery_policy = v;
+    update();
+    Q_EMIT settingsChanged();
+}
+
+void SessionPolicy::setPowerSaverPolicy(Policy v) {
+    if (v == m_saver_policy) return;
+    m_saver_policy = v;
+    update();
+    Q_EMIT settingsChanged();
+}
+
+void SessionPolicy::setLowBattery(int v) {
+    if (v == m_low_battery) return;
+    m_low_battery = v;
+    update();
+    Q_EMIT settingsChanged();
+}
+
+void SessionPolicy::setUnloadAfter(int v) {
+    if (v == m_unload_after) return;
+    m_unload_after = v;
+    // restart with the new delay
+    m_unload.stop();
+    m_unloaded = false;
+    update();
+    Q_EMIT settingsChanged();
+}
+
+std::pair<SessionPolicy::Policy, QString> SessionPolicy::Decide(const SessionState& st,
+                                                                const Settings&     s) {
+    std::pair<Policy, QString> out { Full, {} };
+    auto raise = [&out](Policy p, const char* why) {
+        if (p > out.first) out = { p, why };
+    };
+    // settings only go up to pause, unloading is for an unseen desktop
+    if (st.on_battery) raise(std::min(s.battery, Paused), "battery");
+    if (s.low_battery > 0 && st.battery_percent >= 0 && st.battery_percent < s.low_battery)
+        raise(Paused, "low battery");
+    if (st.power_profile == "power-saver") raise(std::min(s.power_saver, Paused), "power saver");
+    if (st.locked || st.screensaver) raise(Paused, "locked");
+    if (! st.active) raise(Paused, "inactive");
+    if (st.sleeping) raise(Paused, "sleep");
+    return out;
+}
+
+void SessionPolicy::update() {
+    const auto& st = m_monitor->state();
+    auto [policy, why] = Decide(st, Settings { m_battery_policy, m_saver_policy, m_low_battery });
+
+    // nobody sees the desktop, free it all after a while
+    const bool unseen = st.locked || st.screensaver || ! st.active;
+    if (unseen && m_unload_after > 0) {
+        if (m_unloaded) {
+            policy = Unloaded;
+        } else if (! m_unload.isActive()) {
+            m_unload.start(m_unload_after * 1000);
+        }
+    } else {
+        m_unload.stop();
+        m_unloaded = false;
+    }
+
+    if (policy == m_policy && why == m_reason) return;
+    qCDebug(wekdeSession) << "policy" << policy << why;
+    m_policy = policy;
+    m_reason = why;
+    Q_EMIT policyChanged();
+}
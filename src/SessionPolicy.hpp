@@ -0,0 +1,89 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <memory>
+
+#include "SessionMonitor.hpp"
+
+namespace wekde
+{
+
+// throttling tier of one wallpaper instance, from the shared SessionMonitor state
+// and this instance's settings
+class SessionPolicy : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(Policy policy READ policy NOTIFY policyChanged)
+    Q_PROPERTY(QString reason READ reason NOTIFY policyChanged)
+
+    // settings
+    Q_PROPERTY(Policy batteryPolicy MEMBER m_battery_policy WRITE setBatteryPolicy NOTIFY settingsChanged)
+    Q_PROPERTY(Policy powerSaverPolicy MEMBER m_saver_policy WRITE setPowerSaverPolicy NOTIFY settingsChanged)
+    // pause below this battery level, 0 disables
+    Q_PROPERTY(int lowBattery MEMBER m_low_battery WRITE setLowBattery NOTIFY settingsChanged)
+    // seconds locked or inactive before unloading, 0 never unloads
+    Q_PROPERTY(int unloadAfter MEMBER m_unload_after WRITE setUnloadAfter NOTIFY settingsChanged)
+
+    Q_PROPERTY(bool sleeping READ sleeping NOTIFY stateChanged)
+    Q_PROPERTY(bool active READ active NOTIFY stateChanged)
+    Q_PROPERTY(bool locked READ locked NOTIFY stateChanged)
+    Q_PROPERTY(bool onBattery READ onBattery NOTIFY stateChanged)
+    Q_PROPERTY(int batteryPercent READ batteryPercent NOTIFY stateChanged)
+    Q_PROPERTY(QString powerProfile READ powerProfile NOTIFY stateChanged)
+
+public:
+    // ordered, a higher tier saves more
+    enum Policy
+    {
+        Full,
+        Reduced,
+        Paused,
+        Unloaded,
+    };
+    Q_ENUM(Policy)
+
+    SessionPolicy(QObject* parent = nullptr);
+    virtual ~SessionPolicy();
+
+    Policy  policy() const { return m_policy; }
+    QString reason() const { return m_reason; }
+
+    void setBatteryPolicy(Policy);
+    void setPowerSaverPolicy(Policy);
+    void setLowBattery(int);
+    void setUnloadAfter(int);
+
+    bool    sleeping() const { return m_monitor->state().sleeping; }
+    bool    active() const { return m_monitor->state().active; }
+    bool    locked() const { return m_monitor->state().locked || m_monitor->state().screensaver; }
+    bool    onBattery() const { return m_monitor->state().on_battery; }
+    int     batteryPercent() const { return m_monitor->state().battery_percent; }
+    QString powerProfile() const { return m_monitor->state().power_profile; }
+
+    struct Settings {
+        Policy battery { Full };
+        Policy power_saver { Reduced };
+        int    low_battery { 0 };
+    };
+    // tier and reason before unloading kicks in, no bus involved
+    static std::pair<Policy, QString> Decide(const SessionState&, const Settings&);
+
+signals:
+    void policyChanged();
+    void settingsChanged();
+    void stateChanged();
+
+private:
+    void update();
+
+    std::shared_ptr<SessionMonitor> m_monitor;
+    Policy                          m_battery_policy { Full };
+    Policy                          m_saver_policy { Reduced };
+    int                             m_low_battery { 0 };
+    int                             m_unload_after { 0 };
+
+    Policy  m_policy { Full };
+    QString m_reason;
+    QTimer  m_unload;
+    bool    m_unloaded { false };
+};
+} // namespace wekde
@@ -0,0 +1,128 @@
+#include "ThumbnailProvider.hpp"
+#include <QLoggingCategory>
+#include <QCryptographicHash>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QUrl>
+
+#include <atomic>
+#include <thread>
+
+#include "PluginInfo.hpp"
+
+Q_LOGGING_CATEGORY(wekdeThumb, "wekde.thumbnail")
+
+using namespace wekde;
+
+namespace
+{
+constexpr int JpegQuality { 85 };
+// a few per wallpaper, oldest go first
+constexpr int MaxFiles { 4096 };
+
+QString ThumbnailDir() { return PluginInfo::cacheDir() + "/thumbnails"; }
+
+// keys change with the preview mtime, every re-download leaves the old one behind
+void Prune() {
+    QDir dir(ThumbnailDir());
+    auto files = dir.entryInfoList({ "*.jpg" }, QDir::Files, QDir::Time);
+    for (int i = MaxFiles; i < files.size(); i++) QFile::remove(files[i].absoluteFilePath());
+}
+
+class ThumbnailResponse : public QQuickImageResponse, public QRunnable {
+public:
+    ThumbnailResponse(const QString& path, const QSize& size, const std::atomic<bool>* stop)
+        : m_path(path), m_size(size), m_stop(stop) {
+        setAutoDelete(false);
+    }
+
+    // always emits finished, the engine deletes the response only then
+    void run() override {
+        if (! m_canceled && ! *m_stop) m_image = ThumbnailProvider::Load(m_path, m_size);
+        Q_EMIT finished();
+    }
+    void cancel() override { m_canceled = true; }
+
+    QQuickTextureFactory* textureFactory() const override {
+        return QQuickTextureFactory::textureFactoryForImage(m_image);
+    }
+    QString errorString() const override {
+        return m_image.isNull() && ! m_canceled ? "can't load " + m_path : QString();
+    }
+
+private:
+    QString                  m_path;
+    QSize                    m_size;
+    QImage                   m_image;
+    std::atomic<bool>        m_canceled { false };
+    // owned by the provider, which waits for every response
+    const std::atomic<bool>* m_stop;
+};
+} // namespace
+
+ThumbnailProvider::ThumbnailProvider() {
+    // decoding is io and cpu bound, leave room for the render and gui threads
+    m_pool.setMaxThreadCount(std::max(1, (int)std::thread::hardware_concurrency() / 2));
+    m_pool.start([]() {
+        Prune();
+    });
+}
+
+ThumbnailProvider::~ThumbnailProvider() {
+    // queued responses still run, empty, so each one emits finished
+    m_stop = true;
+    m_pool.waitForDone();
+}
+
+QQuickImageResponse* ThumbnailProvider::requestImageResponse(const QString& id,
+                                                             const QSize&   requestedSize) {
+    const QString path = QUrl::fromPercentEncoding(id.toUtf8());
+    auto*         res  = new ThumbnailResponse(path, requestedSize, &m_stop);
+    m_pool.start(res);
+    return res;
+}
+
+QString ThumbnailProvider::CacheFile(const QString& path, const QSize& size) {
+    QFileInfo info(path);
+    if (! info.exists()) return {};
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QFile::encodeName(info.absoluteFilePath()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(size.width()) + 'x' + QByteArray::number(size.height()));
+    return ThumbnailDir() + "/" + hash.result().toHex() + ".jpg";
+}
+
+QImage ThumbnailProvider::Load(const QString& path, const QSize& requestedSize) {
+    const QSize   size  = requestedSize.isValid() ? requestedSize : QSize(256, 256);
+    const QString cache = CacheFile(path, size);
+    if (cache.isEmpty()) return {};
+
+    QImage image;
+    if (image.load(cache)) return image;
+
+    // first frame only, jpeg decoders can scale while decoding
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    const QSize src = reader.size();
+    if (src.isValid()) reader.setScaledSize(src.scaled(size, Qt::KeepAspectRatioByExpanding));
+    if (! reader.read(&image)) {
+        qCDebug(wekdeThumb) << "read failed:" << path << reader.errorString();
+        return {};
+    }
+    if (! src.isValid() && ! image.isNull())
+        image = image.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    if (image.hasAlphaChannel()) image = image.convertToFormat(QImage::Format_RGB32);
+
+    QDir().mkpath(QFileInfo(cache).absolutePath());
+    QSaveFile f(cache);
+    if (f.open(QIODevice::WriteOnly)) {
+        QImageWriter writer(&f, "jpg");
+        writer.setQuality(JpegQuality);
+        if (! writer.write(image) || ! f.commit())
+            qCWarning(wekdeThumb) << "can't write thumbnail:" << cache;
+    }
+    return image;
+}
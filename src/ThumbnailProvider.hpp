@@ -0,0 +1,30 @@
+#pragma once
+#include <QQuickAsyncImageProvider>
+#include <QThreadPool>
+#include <atomic>
+
+namespace wekde
+{
+
+// grid sized static thumbnails of wallpaper previews
+// id is the percent-encoded local path of the preview file
+// first frame is scaled on a worker and kept as jpeg under PluginInfo::cacheDir()
+class ThumbnailProvider : public QQuickAsyncImageProvider {
+public:
+    ThumbnailProvider();
+    virtual ~ThumbnailProvider();
+
+    QQuickImageResponse* requestImageResponse(const QString& id,
+                                              const QSize&   requestedSize) override;
+
+    // key is path, mtime and size, a changed preview gets a new file, the oldest are pruned
+    static QString CacheFile(const QString& path, const QSize& size);
+    static QImage  Load(const QString& path, const QSize& requestedSize);
+
+    static constexpr const char* Name { "wekdethumb" };
+
+private:
+    QThreadPool       m_pool;
+    std::atomic<bool> m_stop { false };
+};
+} // namespace wekde
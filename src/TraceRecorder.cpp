@@ -0,0 +1,71 @@
+#include "TraceRecorder.hpp"
+#include <QLoggingCategory>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QDir>
+#include <QThreadPool>
+#include <QPointer>
+
+#include "Trace.hpp"
+#include "PluginInfo.hpp"
+
+Q_LOGGING_CATEGORY(wekdeTrace, "wekde.trace")
+
+using namespace wekde;
+
+namespace
+{
+constexpr const char* Category { "qml" };
+} // namespace
+
+TraceRecorder::TraceRecorder(QObject* parent): QObject(parent) {}
+
+TraceRecorder::~TraceRecorder() {}
+
+bool TraceRecorder::enabled() const { return mpv::Trace::Enabled(); }
+
+void TraceRecorder::setEnabled(bool v) {
+    if (v == enabled()) return;
+    mpv::Trace::SetEnabled(v);
+    Q_EMIT enabledChanged();
+}
+
+void TraceRecorder::instant(const QString& name, const QString& arg) {
+    if (! enabled()) return;
+    mpv::Trace::Instant(Category, name.toUtf8().constData(), arg.toUtf8().constData());
+}
+
+void TraceRecorder::begin(const QString& name, const QString& id, const QString& arg) {
+    if (! enabled()) return;
+    mpv::Trace::Begin(Category, name.toUtf8().constData(), qHash(id), arg.toUtf8().constData());
+}
+
+void TraceRecorder::end(const QString& name, const QString& id) {
+    if (! enabled()) return;
+    mpv::Trace::End(Category, name.toUtf8().constData(), qHash(id));
+}
+
+void TraceRecorder::save() {
+    const QString dir  = PluginInfo::cacheDir() + "/traces";
+    const QString path = dir + "/trace-" +
+                         QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss") + ".json";
+
+    QPointer<TraceRecorder> self(this);
+    QThreadPool::globalInstance()->start([self, dir, path]() {
+        QDir().mkpath(dir);
+        QSaveFile f(path);
+        const bool ok =
+            f.open(QIODevice::WriteOnly) && f.write(mpv::Trace::Dump()) >= 0 && f.commit();
+        if (ok)
+            qCInfo(wekdeTrace) << "trace saved:" << path;
+        else
+            qCWarning(wekdeTrace) << "can't write trace:" << path;
+        if (! self) return;
+        QMetaObject::invokeMethod(
+            self.data(),
+            [self, path, ok]() {
+                if (self) Q_EMIT self->saved(ok ? path : QString());
+            },
+            Qt::QueuedConnection);
+    });
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <QObject>
+#include <QString>
+
+namespace wekde
+{
+
+// qml side of mpv::Trace, the recording is shared by the whole process
+class TraceRecorder : public QObject {
+    Q_OBJECT
+    // also on with WEKDE_TRACE=1
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged)
+
+public:
+    TraceRecorder(QObject* parent = nullptr);
+    virtual ~TraceRecorder();
+
+    bool enabled() const;
+    void setEnabled(bool);
+
+    Q_INVOKABLE void instant(const QString& name, const QString& arg = {});
+    // async span, id tells overlapping ones with the same name apart
+    Q_INVOKABLE void begin(const QString& name, const QString& id, const QString& arg = {});
+    Q_INVOKABLE void end(const QString& name, const QString& id);
+
+    // chrome trace json under PluginInfo::cacheDir()/traces, written on the thread pool
+    Q_INVOKABLE void save();
+
+signals:
+    void enabledChanged();
+    // path is empty on failure
+    void saved(const QString& path);
+};
+} // namespace wekde
@@ -0,0 +1,198 @@
+#include "WallpaperConfig.hpp"
+#include <QLoggingCategory>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "FileService.hpp"
+
+Q_LOGGING_CATEGORY(wekdeConfig, "wekde.config")
+
+using namespace wekde;
+
+namespace
+{
+// a slider drag sends a change per tick, wait for it to settle
+constexpr int FlushDelayMs { 500 };
+// but never hold changes longer than this
+constexpr int FlushMaxDelayMs { 3000 };
+
+struct Entry {
+    QVariantMap value;
+    bool        dirty { false };
+    bool        removed { false };
+};
+
+// shared by the wallpaper and config engines, only used on the gui thread
+struct Hub {
+    QHash<QString, Entry>            entries;
+    QList<QPointer<WallpaperConfig>> stores;
+    QTimer                           timer;
+    QElapsedTimer                    dirty_since;
+    QThreadPool                      writer;
+    int                              writes { 0 };
+
+    Hub() {
+        timer.setSingleShot(true);
+        QObject::connect(&timer, &QTimer::timeout, [this]() {
+            flush();
+        });
+        // files of one id must land in order
+        writer.setMaxThreadCount(1);
+        QObject::connect(qApp, &QCoreApplication::aboutToQuit, qApp, []() {
+            WallpaperConfig::Sync();
+        });
+    }
+
+    static QString File(const QString& workshopid) {
+        return FileService::WallpaperConfigDir() + '/' + workshopid + ".json";
+    }
+
+    Entry& entry(const QString& workshopid) {
+        auto it = entries.find(workshopid);
+        if (it != entries.end()) return *it;
+
+        Entry e;
+        QFile f(File(workshopid));
+        if (f.open(QIODevice::ReadOnly)) {
+            QJsonParseError error;
+            const auto      doc = QJsonDocument::fromJson(f.readAll(), &error);
+            if (error.error != QJsonParseError::NoError)
+                qCWarning(wekdeConfig) << "can't parse" << f.fileName() << error.errorString();
+            e.value = doc.object().toVariantMap();
+        }
+        return *entries.insert(workshopid, e);
+    }
+
+    bool pending() const {
+        for (const auto& e : entries)
+            if (e.dirty) return true;
+        return false;
+    }
+
+    void schedule() {
+        const bool was = timer.isActive();
+        if (! was) dirty_since.start();
+        if (dirty_since.elapsed() >= FlushMaxDelayMs)
+            flush();
+        else
+            timer.start(FlushDelayMs);
+        if (! was) notify(&WallpaperConfig::pendingChanged);
+    }
+
+    void flush() {
+        timer.stop();
+        int count { 0 };
+        for (auto it = entries.begin(); it != entries.end(); it++) {
+            Entry& e = *it;
+            if (! e.dirty) continue;
+            e.dirty = false;
+            count++;
+
+            const QString file = File(it.key());
+            if (e.removed) {
+                writer.start([file]() {
+                    QFile::remove(file);
+                });
+                continue;
+            }
+            const QByteArray data =
+                QJsonDocument(QJsonObject::fromVariantMap(e.value)).toJson(QJsonDocument::Compact);
+            writer.start([file, data]() {
+                QDir().mkpath(FileService::WallpaperConfigDir());
+                QSaveFile f(file);
+                if (! (f.open(QIODevice::WriteOnly) && f.write(data) >= 0 && f.commit()))
+                    qCWarning(wekdeConfig) << "can't write" << file << f.errorString();
+            });
+        }
+        if (count == 0) return;
+        writes += count;
+        qCDebug(wekdeConfig) << "flushed" << count << "files," << writes << "since start";
+        notify(&WallpaperConfig::pendingChanged);
+        notify(&WallpaperConfig::flushed);
+    }
+
+    template<typename Signal, typename... Args>
+    void notify(Signal signal, const Args&... args) {
+        stores.removeAll(nullptr);
+        for (const auto& s : stores) Q_EMIT(s.data()->*signal)(args...);
+    }
+};
+
+Hub& Shared() {
+    // never destroyed, the quit hook does the last flush
+    static Hub* hub = new Hub;
+    return *hub;
+}
+} // namespace
+
+WallpaperConfig::WallpaperConfig(QObject* parent): QObject(parent) {
+    Shared().stores.append(this);
+}
+
+WallpaperConfig::~WallpaperConfig() { Shared().stores.removeAll(this); }
+
+int WallpaperConfig::diskWrites() const { return Shared().writes; }
+
+bool WallpaperConfig::pending() const { return Shared().pending(); }
+
+QVariantMap WallpaperConfig::read(const QString& workshopid) {
+    if (workshopid.isEmpty()) return {};
+    return Shared().entry(workshopid).value;
+}
+
+void WallpaperConfig::write(const QString& workshopid, const QVariantMap& changed) {
+    update({ { workshopid, changed } });
+}
+
+void WallpaperConfig::update(const QVariantMap& batch) {
+    auto&       hub = Shared();
+    QStringList ids;
+    for (auto it = batch.begin(); it != batch.end(); it++) {
+        if (it.key().isEmpty()) continue;
+        Entry&            e       = hub.entry(it.key());
+        const QVariantMap changed = it.value().toMap();
+        bool              diff { false };
+        for (auto c = changed.begin(); c != changed.end(); c++) {
+            auto old = e.value.constFind(c.key());
+            if (old != e.value.cend() && *old == c.value()) continue;
+            e.value.insert(c.key(), c.value());
+            diff = true;
+        }
+        if (! diff) continue;
+        e.dirty   = true;
+        e.removed = false;
+        ids << it.key();
+    }
+    if (ids.isEmpty()) return;
+    hub.schedule();
+    for (const auto& id : ids) hub.notify(&WallpaperConfig::changed, id);
+}
+
+void WallpaperConfig::reset(const QString& workshopid) {
+    if (workshopid.isEmpty()) return;
+    auto&  hub = Shared();
+    Entry& e   = hub.entry(workshopid);
+    e.value.clear();
+    e.dirty   = true;
+    e.removed = true;
+    hub.schedule();
+    hub.notify(&WallpaperConfig::changed, workshopid);
+}
+
+void WallpaperConfig::flush() { Shared().flush(); }
+
+void WallpaperConfig::Sync() {
+    auto& hub = Shared();
+    hub.flush();
+    hub.writer.waitForDone();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVariant>
+
+namespace wekde
+{
+
+// per wallpaper options, native replacement of the pyext *_wallpaper_config methods
+// one in-memory cache for the whole process, files are the same as pyext writes
+// writes are merged per workshop id and flushed with QSaveFile once a burst settles
+class WallpaperConfig : public QObject {
+    Q_OBJECT
+    // files handed to the writer since start, for checking that bursts collapse
+    Q_PROPERTY(int diskWrites READ diskWrites NOTIFY flushed)
+    Q_PROPERTY(bool pending READ pending NOTIFY pendingChanged)
+
+public:
+    WallpaperConfig(QObject* parent = nullptr);
+    virtual ~WallpaperConfig();
+
+    int  diskWrites() const;
+    bool pending() const;
+
+    // the file is only read on the first access of each id
+    Q_INVOKABLE QVariantMap read(const QString& workshopid);
+    // merge changed into the options of workshopid
+    Q_INVOKABLE void write(const QString& workshopid, const QVariantMap& changed);
+    // batch: { workshopid: changed, ... }, one notification per id
+    Q_INVOKABLE void update(const QVariantMap& batch);
+    // drop all options, the file is removed on flush
+    Q_INVOKABLE void reset(const QString& workshopid);
+    // write pending changes now instead of after the delay
+    Q_INVOKABLE void flush();
+
+    // flushes and waits for the files, also done on application quit
+    static void Sync();
+
+signals:
+    void changed(const QString& workshopid);
+    void pendingChanged();
+    void flushed();
+};
+} // namespace wekde
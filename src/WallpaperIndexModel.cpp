@@ -0,0 +1,380 @@
+#include "WallpaperIndexModel.hpp"
+#include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+#include <numeric>
+
+Q_LOGGING_CATEGORY(wekdeIndex, "wekde.index")
+
+using namespace wekde;
+
+namespace
+{
+// same fields as Common.wpitem_template, plus what the library adds
+const QList<QByteArray> RoleKeys { "workshopid", "path",    "loaded",    "title",
+                                   "preview",    "file",    "type",      "contentrating",
+                                   "tags",       "favor",   "playlists", "modified" };
+
+// tags and playlists come as [{key: ...}] from qml
+QStringList Keys(const QVariant& v) {
+    QStringList out;
+    for (const auto& el : v.toList()) {
+        if (el.canConvert<QVariantMap>() && el.toMap().contains("key"))
+            out << el.toMap().value("key").toString();
+        else
+            out << el.toString();
+    }
+    return out;
+}
+
+bool Intersects(const QStringList& a, const QStringList& b) {
+    for (const auto& el : a)
+        if (b.contains(el)) return true;
+    return false;
+}
+} // namespace
+
+WallpaperIndexModel::WallpaperIndexModel(QObject* parent): QAbstractListModel(parent) {}
+
+WallpaperIndexModel::~WallpaperIndexModel() {}
+
+int WallpaperIndexModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant WallpaperIndexModel::data(const QModelIndex& index, int role) const {
+    const int row = index.row();
+    const int key = role - Qt::UserRole;
+    if (row < 0 || row >= count() || key < 0 || key >= RoleKeys.size()) return {};
+    const int id = m_rows[row];
+    // dropped row, only seen while a delta is applied
+    if (id < 0) return {};
+    return m_items[id].data.value(QString::fromLatin1(RoleKeys[key]));
+}
+
+QHash<int, QByteArray> WallpaperIndexModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    for (int i = 0; i < RoleKeys.size(); i++) roles[Qt::UserRole + i] = RoleKeys[i];
+    return roles;
+}
+
+QStringList WallpaperIndexModel::Words(const QString& str) {
+    QStringList out;
+    QString     word;
+    for (const QChar c : str) {
+        if (c.isLetterOrNumber()) {
+            word += c.toLower();
+        } else if (! word.isEmpty()) {
+            out << word;
+            word.clear();
+        }
+    }
+    if (! word.isEmpty()) out << word;
+    return out;
+}
+
+WallpaperIndexModel::Item WallpaperIndexModel::MakeItem(const QVariant& v) {
+    Item item;
+    item.data       = v.toMap();
+    item.workshopid = item.data.value("workshopid").toString();
+    item.title      = item.data.value("title").toString();
+    item.modified   = item.data.value("modified").toLongLong();
+    item.type       = item.data.value("type").toString();
+    item.rating     = item.data.value("contentrating").toString();
+    item.tags       = Keys(item.data.value("tags"));
+    item.playlists  = Keys(item.data.value("playlists"));
+    item.favor      = item.data.value("favor").toBool();
+    return item;
+}
+
+void WallpaperIndexModel::setItems(const QVariantList& items) {
+    m_items.clear();
+    m_items.reserve(items.size());
+    for (const auto& el : items) m_items.push_back(MakeItem(el));
+    const bool total = rebuild();
+    match(false);
+    present(true);
+    if (total) Q_EMIT totalCountChanged();
+}
+
+void WallpaperIndexModel::applyDelta(const QVariantList& added, const QVariantList& changed,
+                                     const QStringList& removed) {
+    QSet<QString> drop(removed.begin(), removed.end());
+    QSet<QString> redo;
+    for (const auto& el : changed) redo.insert(el.toMap().value("workshopid").toString());
+    drop.unite(redo);
+
+    QStringList before;
+    for (int id : m_rows) before << m_items[id].workshopid;
+
+    for (auto& item : m_items)
+        if (drop.contains(item.workshopid)) item.alive = false;
+    for (const auto& el : added) m_items.push_back(MakeItem(el));
+    for (const auto& el : changed) m_items.push_back(MakeItem(el));
+    // deltas come from the watcher and are rare, index and orders are rebuilt
+    const bool total = rebuild();
+    match(false);
+
+    QHash<QString, int> ids;
+    for (int i = 0; i < (int)m_items.size(); i++) ids.insert(m_items[i].workshopid, i);
+    // changed items leave and come back, like the js list does
+    for (int i = 0; i < before.size(); i++)
+        m_rows[i] = redo.contains(before[i]) ? -1 : ids.value(before[i], -1);
+
+    present(false);
+    if (total) Q_EMIT totalCountChanged();
+}
+
+bool WallpaperIndexModel::rebuild() {
+    QElapsedTimer clock;
+    clock.start();
+
+    m_items.erase(std::remove_if(m_items.begin(), m_items.end(),
+                                 [](const Item& item) {
+                                     return ! item.alive;
+                                 }),
+                  m_items.end());
+    const int  size  = (int)m_items.size();
+    const bool total = size != m_total;
+    m_total          = size;
+
+    std::vector<std::pair<QString, int>> pairs;
+    for (int id = 0; id < size; id++) {
+        Item&       item = m_items[id];
+        QStringList words;
+        words << Words(item.title) << Words(item.type) << Words(item.rating)
+              << item.workshopid.toLower();
+        for (const auto& tag : item.tags) words << Words(tag);
+        words.removeDuplicates();
+        item.tokens.clear();
+        for (auto& w : words)
+            if (! w.isEmpty()) pairs.emplace_back(std::move(w), id);
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    m_tokens.clear();
+    m_postings.clear();
+    for (auto& [token, id] : pairs) {
+        if (m_tokens.empty() || m_tokens.back() != token) {
+            m_tokens.push_back(std::move(token));
+            m_postings.emplace_back();
+        }
+        m_postings.back().push_back(id);
+        m_items[id].tokens.push_back((int)m_tokens.size() - 1);
+    }
+
+    // ties fall back to workshop id, so the order does not depend on input order
+    auto by_id = [this](int a, int b) {
+        return m_items[a].workshopid < m_items[b].workshopid;
+    };
+    auto by_name = [this, &by_id](int a, int b) {
+        const auto& ta = m_items[a].title;
+        const auto& tb = m_items[b].title;
+        return ta != tb ? ta < tb : by_id(a, b);
+    };
+    auto by_modified = [this, &by_id](int a, int b) {
+        const qint64 ma = m_items[a].modified;
+        const qint64 mb = m_items[b].modified;
+        return ma != mb ? ma > mb : by_id(a, b);
+    };
+    for (int mode = 0; mode < SortCount; mode++) {
+        auto& order = m_order[mode];
+        order.resize(size);
+        std::iota(order.begin(), order.end(), 0);
+        if (mode == SortName)
+            std::sort(order.begin(), order.end(), by_name);
+        else if (mode == SortModified)
+            std::sort(order.begin(), order.end(), by_modified);
+        else
+            std::sort(order.begin(), order.end(), by_id);
+
+        auto& rank = m_rank[mode];
+        rank.resize(size);
+        for (int i = 0; i < size; i++) rank[order[i]] = i;
+    }
+
+    m_pass.resize(size);
+    for (int id = 0; id < size; id++) m_pass[id] = pass(m_items[id]);
+
+    qCDebug(wekdeIndex) << "indexed" << size << "items," << m_tokens.size() << "tokens in"
+                        << clock.elapsed() << "ms";
+    return total;
+}
+
+bool WallpaperIndexModel::pass(const Item& item) const {
+    const auto& f = m_filter;
+    if (! f.active) return true;
+    if (! f.types.contains(item.type) || ! f.types.contains(item.rating)) return false;
+    if (f.only_favor && ! item.favor) return false;
+    if (Intersects(item.tags, f.no_tags)) return false;
+    return f.playlists.isEmpty() || Intersects(item.playlists, f.playlists);
+}
+
+bool WallpaperIndexModel::matches(const Item& item, const QStringList& terms) const {
+    for (const auto& term : terms) {
+        const bool found = std::any_of(item.tokens.begin(), item.tokens.end(), [&](int t) {
+            return m_tokens[t].startsWith(term);
+        });
+        if (! found) return false;
+    }
+    return true;
+}
+
+void WallpaperIndexModel::lookup(const QString& prefix, std::vector<int>& out) const {
+    out.clear();
+    // tokens with the prefix are one contiguous range
+    auto it = std::lower_bound(m_tokens.begin(), m_tokens.end(), prefix);
+    for (; it != m_tokens.end() && it->startsWith(prefix); it++) {
+        const auto& ids = m_postings[it - m_tokens.begin()];
+        out.insert(out.end(), ids.begin(), ids.end());
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+void WallpaperIndexModel::match(bool narrow) {
+    if (m_terms.isEmpty()) {
+        m_match_all = true;
+        m_matched.clear();
+        return;
+    }
+    if (! narrow || m_match_all) {
+        // start from the rarest term, the others are checked on its items only
+        std::vector<int> ids;
+        m_matched.clear();
+        bool first = true;
+        for (const auto& term : m_terms) {
+            lookup(term, ids);
+            if (first || ids.size() < m_matched.size()) std::swap(m_matched, ids);
+            first = false;
+        }
+    }
+    m_match_all = false;
+    m_matched.erase(std::remove_if(m_matched.begin(), m_matched.end(),
+                                   [this](int id) {
+                                       return ! matches(m_items[id], m_terms);
+                                   }),
+                    m_matched.end());
+}
+
+void WallpaperIndexModel::present(bool reset) {
+    const auto&      order = m_order[m_sort];
+    std::vector<int> next;
+    if (m_match_all) {
+        for (int id : order)
+            if (m_pass[id]) next.push_back(id);
+    } else {
+        for (int id : m_matched)
+            if (m_pass[id]) next.push_back(id);
+        // few matches sort by rank, many are picked in order
+        if (next.size() * 16 < order.size()) {
+            const auto& rank = m_rank[m_sort];
+            std::sort(next.begin(), next.end(), [&rank](int a, int b) {
+                return rank[a] < rank[b];
+            });
+        } else {
+            std::vector<char> hit(order.size(), 0);
+            for (int id : next) hit[id] = 1;
+            next.clear();
+            for (int id : order)
+                if (hit[id]) next.push_back(id);
+        }
+    }
+
+    const int old_count = count();
+    if (reset) {
+        beginResetModel();
+        m_rows = std::move(next);
+        endResetModel();
+    } else {
+        // kept rows are a subsequence of next, drop the others then insert the new ones
+        for (int row = (int)m_rows.size() - 1; row >= 0; row--) {
+            const int id = m_rows[row];
+            if (id >= 0 && m_pass[id] && (m_match_all || std::binary_search(m_matched.begin(),
+                                                                            m_matched.end(),
+                                                                            id)))
+                continue;
+            beginRemoveRows(QModelIndex(), row, row);
+            m_rows.erase(m_rows.begin() + row);
+            endRemoveRows();
+        }
+        for (int row = 0; row < (int)next.size(); row++) {
+            if (row < (int)m_rows.size() && m_rows[row] == next[row]) continue;
+            beginInsertRows(QModelIndex(), row, row);
+            m_rows.insert(m_rows.begin() + row, next[row]);
+            endInsertRows();
+        }
+        if (m_rows != next) {
+            qCWarning(wekdeIndex) << "row update out of order, reset";
+            beginResetModel();
+            m_rows = std::move(next);
+            endResetModel();
+        }
+    }
+    if (count() != old_count) Q_EMIT countChanged();
+}
+
+void WallpaperIndexModel::setQuery(const QString& v) {
+    if (v == m_query) return;
+    m_query                 = v;
+    const QStringList terms = Words(v);
+    Q_EMIT queryChanged();
+    if (terms == m_terms) return;
+
+    // every new term extends the old one at its place, old matches are a superset
+    bool narrow = ! m_terms.isEmpty() && terms.size() >= m_terms.size();
+    for (int i = 0; narrow && i < m_terms.size(); i++) narrow = terms[i].startsWith(m_terms[i]);
+    m_terms = terms;
+    match(narrow);
+    present(true);
+}
+
+void WallpaperIndexModel::setSortMode(int v) {
+    if (v < 0 || v >= SortCount) v = SortId;
+    if (v == m_sort) return;
+    m_sort = v;
+    Q_EMIT sortModeChanged();
+    present(true);
+}
+
+void WallpaperIndexModel::setFilters(const QVariantList& filters) {
+    Filter f;
+    f.active = true;
+    for (const auto& el : filters) {
+        const QVariantMap m     = el.toMap();
+        const QString     type  = m.value("type").toString();
+        const QString     key   = m.value("key").toString();
+        const bool        value = m.value("value").toBool();
+        if (type == "type" || type == "contentrating") {
+            if (value) f.types << key;
+        } else if (type == "favor") {
+            f.only_favor = value;
+        } else if (type == "tags") {
+            if (! value) f.no_tags << key;
+        } else if (type == "playlist") {
+            if (value) f.playlists << key;
+        }
+    }
+    m_filter = f;
+    for (int id = 0; id < (int)m_items.size(); id++) m_pass[id] = pass(m_items[id]);
+    present(true);
+}
+
+QVariantMap WallpaperIndexModel::get(int row) const {
+    if (row < 0 || row >= count() || m_rows[row] < 0) return {};
+    return m_items[m_rows[row]].data;
+}
+
+void WallpaperIndexModel::assignModel(int row, const QVariantMap& value) {
+    if (row < 0 || row >= count() || m_rows[row] < 0) return;
+    const int id   = m_rows[row];
+    Item&     item = m_items[id];
+    for (auto it = value.begin(); it != value.end(); it++) item.data.insert(it.key(), it.value());
+    if (value.contains("favor")) item.favor = value.value("favor").toBool();
+    m_pass[id] = pass(item);
+    const QModelIndex idx = index(row);
+    Q_EMIT dataChanged(idx, idx);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <QAbstractListModel>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <array>
+#include <vector>
+
+namespace wekde
+{
+
+// filtered and sorted wallpaper list for the grid, replaces the js filterToList
+// query words are matched as prefixes through an inverted index and the sort orders are
+// kept per mode, so a keystroke costs about the matching items instead of the library
+class WallpaperIndexModel : public QAbstractListModel {
+    Q_OBJECT
+    // visible rows
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    // all items, before query and filters
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY totalCountChanged)
+    // each word must prefix a word of title, tags, type, content rating or workshop id
+    Q_PROPERTY(QString query READ query WRITE setQuery NOTIFY queryChanged)
+    // Common.SortMode
+    Q_PROPERTY(int sortMode READ sortMode WRITE setSortMode NOTIFY sortModeChanged)
+
+public:
+    enum SortMode
+    {
+        SortId = 0,
+        SortName,
+        SortModified,
+        SortCount
+    };
+
+    WallpaperIndexModel(QObject* parent = nullptr);
+    virtual ~WallpaperIndexModel();
+
+    int     count() const { return (int)m_rows.size(); }
+    int     totalCount() const { return m_total; }
+    QString query() const { return m_query; }
+    int     sortMode() const { return m_sort; }
+    void    setQuery(const QString&);
+    void    setSortMode(int);
+
+    int                    rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant               data(const QModelIndex& index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // items: list of map, same fields as Common.wpitem_template
+    Q_INVOKABLE void setItems(const QVariantList& items);
+    // changed items are matched by workshopid, rows not touched keep their place
+    Q_INVOKABLE void applyDelta(const QVariantList& added, const QVariantList& changed,
+                                const QStringList& removed);
+    // list of {type, key, value}, as Common.filterModel.genFilter takes
+    Q_INVOKABLE void        setFilters(const QVariantList& filters);
+    Q_INVOKABLE QVariantMap get(int row) const;
+    // ListModel compatible, merge value into the row without filtering again
+    Q_INVOKABLE void assignModel(int row, const QVariantMap& value);
+
+    // lower case words, split on anything not a letter or digit
+    static QStringList Words(const QString&);
+
+signals:
+    void countChanged();
+    void totalCountChanged();
+    void queryChanged();
+    void sortModeChanged();
+
+private:
+    struct Item {
+        QVariantMap      data;
+        QString          workshopid;
+        QString          title;
+        qint64           modified { 0 };
+        QString          type;
+        QString          rating;
+        QStringList      tags;
+        QStringList      playlists;
+        bool             favor { false };
+        bool             alive { true };
+        std::vector<int> tokens; // into m_tokens
+    };
+    struct Filter {
+        bool        active { false };
+        QStringList types; // type and content rating keys that are on
+        QStringList no_tags;
+        QStringList playlists;
+        bool        only_favor { false };
+    };
+
+    static Item MakeItem(const QVariant&);
+    // true when the item count changed
+    bool        rebuild();
+    bool        pass(const Item&) const;
+    bool        matches(const Item&, const QStringList& terms) const;
+    void        lookup(const QString& prefix, std::vector<int>& out) const;
+    void        match(bool narrow);
+    void        present(bool reset);
+
+    std::vector<Item> m_items;
+    int               m_total { 0 };
+
+    // sorted, with postings of item ids for each
+    std::vector<QString>          m_tokens;
+    std::vector<std::vector<int>> m_postings;
+
+    std::array<std::vector<int>, SortCount> m_order; // item ids in sort order
+    std::array<std::vector<int>, SortCount> m_rank;  // item id -> position in m_order
+
+    Filter            m_filter;
+    std::vector<char> m_pass; // item id -> passes m_filter
+
+    QString          m_query;
+    QStringList      m_terms;
+    bool             m_match_all { true };
+    std::vector<int> m_matched; // item ids matching m_terms, ascending
+
+    int              m_sort { SortId };
+    std::vector<int> m_rows;
+};
+} // namespace wekde
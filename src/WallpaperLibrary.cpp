@@ -0,0 +1,447 @@
+#include "WallpaperLibrary.hpp"
+#include <QLoggingCategory>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThreadPool>
+#include <QUrl>
+#include <QPointer>
+#include <QMutex>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <sys/stat.h>
+
+#include "PluginInfo.hpp"
+#include "LibraryWatcher.hpp"
+
+Q_LOGGING_CATEGORY(wekdeLibrary, "wekde.library")
+
+using namespace wekde;
+
+namespace
+{
+constexpr quint32 IndexMagic { 0x57454b4c }; // WEKL
+constexpr quint32 IndexVersion { 1 };
+
+// scan and watcher updates both rewrite the index file
+QMutex IndexFileMutex;
+
+QDataStream& operator<<(QDataStream& out, const LibraryEntry& e) {
+    out << e.path << e.workshopid << e.mtime << e.project_mtime << e.title << e.preview << e.file
+        << e.type << e.contentrating << e.description << e.tags << e.valid;
+    return out;
+}
+QDataStream& operator>>(QDataStream& in, LibraryEntry& e) {
+    in >> e.path >> e.workshopid >> e.mtime >> e.project_mtime >> e.title >> e.preview >> e.file >>
+        e.type >> e.contentrating >> e.description >> e.tags >> e.valid;
+    return in;
+}
+
+// mtime of path in ms, -1 if not exist
+qint64 StatMtime(const QByteArray& path, bool* is_dir = nullptr) {
+    struct stat st;
+    if (::stat(path.constData(), &st) != 0) return -1;
+    if (is_dir) *is_dir = S_ISDIR(st.st_mode);
+    return qint64(st.st_mtim.tv_sec) * 1000 + st.st_mtim.tv_nsec / 1000000;
+}
+
+QString ToLocalPath(const QVariant& v) {
+    QString str = v.toString();
+    if (str.startsWith("file:")) return QUrl(str).toLocalFile();
+    return str;
+}
+} // namespace
+
+QVariantMap LibraryEntry::toVariant() const {
+    QVariantMap m;
+    m["workshopid"] = workshopid;
+    m["path"]       = QUrl::fromLocalFile(path).toString();
+    m["modified"]   = mtime;
+    if (! valid) return m;
+
+    if (! title.isEmpty()) m["title"] = title;
+    if (! preview.isEmpty()) m["preview"] = preview;
+    if (! file.isEmpty()) m["file"] = file;
+    if (! type.isEmpty()) m["type"] = type;
+    if (! contentrating.isEmpty()) m["contentrating"] = contentrating;
+    QVariantList qtags;
+    for (auto& t : tags) qtags.append(QVariantMap { { "key", t } });
+    m["tags"] = qtags;
+    return m;
+}
+
+bool LibraryIndex::load(const QString& path) {
+    QFile f(path);
+    if (! f.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&f);
+    quint32     magic { 0 }, version { 0 };
+    in >> magic >> version;
+    if (magic != IndexMagic || version != IndexVersion) return false;
+
+    qint32 num { 0 };
+    in >> num;
+    m_entries.clear();
+    m_entries.reserve(num);
+    for (qint32 i = 0; i < num && in.status() == QDataStream::Ok; i++) {
+        LibraryEntry e;
+        in >> e;
+        m_entries.insert(e.path, e);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qCWarning(wekdeLibrary) << "broken index file:" << path;
+        m_entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool LibraryIndex::save(const QString& path) const {
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile f(path);
+    if (! f.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&f);
+    out << IndexMagic << IndexVersion << qint32(m_entries.size());
+    for (auto& e : m_entries) out << e;
+    return f.commit();
+}
+
+const LibraryEntry* LibraryIndex::find(const QString& path) const {
+    auto it = m_entries.constFind(path);
+    return it == m_entries.cend() ? nullptr : &it.value();
+}
+
+void LibraryIndex::insert(const LibraryEntry& e) { m_entries.insert(e.path, e); }
+
+bool LibraryIndex::remove(const QString& path) { return m_entries.remove(path) > 0; }
+
+bool LibraryIndex::retain(const QHash<QString, bool>& alive) {
+    bool removed { false };
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (! alive.contains(it.key())) {
+            it      = m_entries.erase(it);
+            removed = true;
+        } else
+            ++it;
+    }
+    return removed;
+}
+
+QString LibraryIndex::defaultFile() { return PluginInfo::cacheDir() + "/wplibrary.index"; }
+
+WallpaperLibrary::WallpaperLibrary(QObject* parent): QObject(parent) {}
+
+WallpaperLibrary::~WallpaperLibrary() {}
+
+QString WallpaperLibrary::ResolveRoot(const QStringList& candidates) {
+    for (auto& c : candidates) {
+        bool is_dir { false };
+        if (StatMtime(QFile::encodeName(c), &is_dir) >= 0 && is_dir) return c;
+    }
+    return {};
+}
+
+LibraryEntry WallpaperLibrary::ParseEntry(const QString& dir) {
+    LibraryEntry e;
+    e.path       = dir;
+    e.workshopid = QFileInfo(dir).fileName();
+
+    QFile f(dir + "/project.json");
+    if (! f.open(QIODevice::ReadOnly)) return e;
+
+    QJsonParseError err;
+    auto            doc = QJsonDocument::fromJson(f.readAll(), &err);
+    if (err.error != QJsonParseError::NoError || ! doc.isObject()) {
+        qCDebug(wekdeLibrary) << "parse failed:" << f.fileName() << err.errorString();
+        return e;
+    }
+    auto project    = doc.object();
+    e.title         = project.value("title").toString();
+    e.preview       = project.value("preview").toString();
+    e.file          = project.value("file").toString();
+    e.type          = project.value("type").toString().toLower();
+    e.contentrating = project.value("contentrating").toString();
+    e.description   = project.value("description").toString();
+    for (const auto& t : project.value("tags").toArray()) e.tags.append(t.toString());
+    e.valid = true;
+    return e;
+}
+
+LibraryEntry WallpaperLibrary::LoadEntry(const QString& dir, const LibraryIndex* cache,
+                                         bool* fresh) {
+    bool         is_dir { false };
+    const qint64 mtime = StatMtime(QFile::encodeName(dir), &is_dir);
+    if (mtime < 0 || ! is_dir) return {};
+    const qint64 project = StatMtime(QFile::encodeName(dir + "/project.json"));
+
+    const LibraryEntry* cached = cache ? cache->find(dir) : nullptr;
+    if (cached && cached->mtime == mtime / 1000 && cached->project_mtime == project) {
+        if (fresh) *fresh = false;
+        return *cached;
+    }
+    LibraryEntry e  = ParseEntry(dir);
+    e.mtime         = mtime / 1000;
+    e.project_mtime = project;
+    if (fresh) *fresh = true;
+    return e;
+}
+
+QVector<LibraryEntry> WallpaperLibrary::ScanRoots(const QVector<QStringList>& roots,
+                                                  LibraryIndex& index, int* reparsed,
+                                                  QStringList* resolved) {
+    QVector<QString> dirs;
+    for (auto& candidates : roots) {
+        QString root = ResolveRoot(candidates);
+        if (root.isEmpty()) {
+            if (! candidates.isEmpty()) qCDebug(wekdeLibrary) << "folder not found:" << candidates[0];
+            continue;
+        }
+        if (resolved) resolved->append(root);
+        const auto names = QDir(root).entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (auto& n : names) dirs.append(root + '/' + n);
+    }
+
+    QVector<LibraryEntry> result(dirs.size());
+    std::vector<char>     fresh(dirs.size(), 0);
+    std::atomic<int>      next { 0 };
+
+    // index and dirs are only read while workers run, each worker owns its result slots
+    const LibraryIndex&     cindex = index;
+    const QVector<QString>& cdirs  = dirs;
+    LibraryEntry*           out    = result.data();
+    auto                    work   = [&]() {
+        for (int i = next++; i < cdirs.size(); i = next++) {
+            bool is_fresh { false };
+            out[i]   = LoadEntry(cdirs[i], &cindex, &is_fresh);
+            fresh[i] = is_fresh;
+        }
+    };
+
+    const int threads =
+        std::clamp<int>(std::thread::hardware_concurrency(), 1, std::max(1, (int)dirs.size() / 16));
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; i++) workers.emplace_back(work);
+    work();
+    for (auto& t : workers) t.join();
+
+    QHash<QString, bool> alive;
+    int                  num_fresh { 0 };
+    for (int i = 0; i < result.size(); i++) {
+        if (result[i].path.isEmpty()) continue;
+        alive.insert(result[i].path, true);
+        if (fresh[i]) {
+            index.insert(result[i]);
+            num_fresh++;
+        }
+    }
+    // removed between listing and stat
+    result.removeIf([](const LibraryEntry& e) {
+        return e.path.isEmpty();
+    });
+    const bool removed = index.retain(alive);
+    if (reparsed) *reparsed = (num_fresh == 0 && removed) ? -1 : num_fresh;
+    return result;
+}
+
+void WallpaperLibrary::scan(const QVariantList& roots) {
+    QVector<QStringList> croots;
+    for (auto& r : roots) {
+        QStringList candidates;
+        if (r.canConvert<QVariantList>() && r.typeId() != QMetaType::QString) {
+            for (auto& c : r.toList()) candidates.append(ToLocalPath(c));
+        } else {
+            candidates.append(ToLocalPath(r));
+        }
+        croots.append(candidates);
+    }
+    m_roots = croots;
+    rescan();
+}
+
+void WallpaperLibrary::rescan() {
+    if (m_busy) {
+        m_rescan = true;
+        return;
+    }
+    setBusy(true);
+    // results of in-flight updates are older than this scan
+    m_generation++;
+    takeDirty();
+
+    const auto                 croots = m_roots;
+    QPointer<WallpaperLibrary> self(this);
+    QThreadPool::globalInstance()->start([self, croots]() {
+        const QString file = LibraryIndex::defaultFile();
+        QStringList   resolved;
+        int           reparsed { 0 };
+
+        QVector<LibraryEntry> entries;
+        {
+            QMutexLocker lock(&IndexFileMutex);
+            LibraryIndex index;
+            index.load(file);
+            entries = ScanRoots(croots, index, &reparsed, &resolved);
+            if (reparsed != 0) {
+                if (! index.save(file)) qCWarning(wekdeLibrary) << "can't write index:" << file;
+            }
+        }
+        if (! self) return;
+        QMetaObject::invokeMethod(
+            self.data(),
+            [self, entries, reparsed, resolved]() {
+                if (self) self->onScanned(entries, reparsed, resolved);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void WallpaperLibrary::onScanned(const QVector<LibraryEntry>& entries, int reparsed,
+                                 const QStringList& resolved) {
+    m_entries.clear();
+    m_entries.reserve(entries.size());
+    for (auto& e : entries) m_entries.insert(e.path, e);
+    m_resolved = resolved;
+    m_reparsed = std::max(reparsed, 0);
+    qCDebug(wekdeLibrary) << "scanned" << entries.size() << "items," << reparsed << "reparsed";
+
+    QVariantList items;
+    items.reserve(entries.size());
+    for (auto& e : entries) items.append(e.toVariant());
+    Q_EMIT countChanged();
+    Q_EMIT scanned(items);
+
+    setBusy(false);
+    if (m_rescan) {
+        m_rescan = false;
+        rescan();
+        return;
+    }
+    if (m_watcher) m_watcher->setDirs(m_resolved, m_entries.keys());
+    // changes during the scan, it may have listed those folders before they changed
+    if (! m_dirty.isEmpty() && ! m_updating) onDirty(takeDirty());
+}
+
+void WallpaperLibrary::setWatch(bool v) {
+    if (v == m_watch) return;
+    m_watch = v;
+    if (m_watch) {
+        m_watcher = new LibraryWatcher(this);
+        connect(m_watcher, &LibraryWatcher::dirty, this, &WallpaperLibrary::onDirty);
+        connect(m_watcher, &LibraryWatcher::overflow, this, &WallpaperLibrary::rescan);
+        if (! m_busy && ! m_resolved.isEmpty()) m_watcher->setDirs(m_resolved, m_entries.keys());
+    } else {
+        delete m_watcher;
+        m_watcher = nullptr;
+        takeDirty();
+    }
+    Q_EMIT watchChanged();
+}
+
+void WallpaperLibrary::onDirty(const QStringList& dirs) {
+    // replayed when the scan or update finishes
+    if (m_busy || m_updating) {
+        for (auto& d : dirs) {
+            if (m_dirty_set.contains(d)) continue;
+            m_dirty_set.insert(d);
+            m_dirty.append(d);
+        }
+        return;
+    }
+    m_updating = true;
+
+    const int                  generation = m_generation;
+    QPointer<WallpaperLibrary> self(this);
+    QThreadPool::globalInstance()->start([self, dirs, generation]() {
+        const QString         file = LibraryIndex::defaultFile();
+        QVector<LibraryEntry> entries;
+        entries.reserve(dirs.size());
+        {
+            QMutexLocker lock(&IndexFileMutex);
+            LibraryIndex index;
+            index.load(file);
+            bool modified { false };
+            for (auto& d : dirs) {
+                bool fresh { false };
+                auto e = LoadEntry(d, &index, &fresh);
+                if (e.path.isEmpty()) {
+                    modified |= index.remove(d);
+                } else if (fresh) {
+                    index.insert(e);
+                    modified = true;
+                }
+                entries.append(e);
+            }
+            if (modified && ! index.save(file))
+                qCWarning(wekdeLibrary) << "can't write index:" << file;
+        }
+        if (! self) return;
+        QMetaObject::invokeMethod(
+            self.data(),
+            [self, dirs, entries, generation]() {
+                if (! self) return;
+                if (generation == self->m_generation) self->onUpdated(dirs, entries);
+                self->m_updating = false;
+                if (! self->m_dirty.isEmpty()) {
+                    const auto next = self->takeDirty();
+                    self->onDirty(next);
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+QStringList WallpaperLibrary::takeDirty() {
+    m_dirty_set.clear();
+    return std::exchange(m_dirty, {});
+}
+
+void WallpaperLibrary::onUpdated(const QStringList& dirs, const QVector<LibraryEntry>& entries) {
+    QVariantList added, changed;
+    QStringList  removed;
+    for (int i = 0; i < dirs.size(); i++) {
+        const auto& e  = entries[i];
+        auto        it = m_entries.find(dirs[i]);
+        if (e.path.isEmpty()) {
+            if (it == m_entries.end()) continue;
+            removed.append(it->workshopid);
+            m_entries.erase(it);
+        } else if (it == m_entries.end()) {
+            m_entries.insert(e.path, e);
+            added.append(e.toVariant());
+        } else if (it->mtime != e.mtime || it->project_mtime != e.project_mtime) {
+            *it = e;
+            changed.append(e.toVariant());
+        }
+    }
+    qCDebug(wekdeLibrary) << "updated" << added.size() << "added," << changed.size() << "changed,"
+                          << removed.size() << "removed";
+
+    if (! added.isEmpty() || ! removed.isEmpty()) Q_EMIT countChanged();
+    if (! removed.isEmpty()) Q_EMIT itemsRemoved(removed);
+    if (! added.isEmpty()) Q_EMIT itemsAdded(added);
+    if (! changed.isEmpty()) Q_EMIT itemsChanged(changed);
+}
+
+QVariantMap WallpaperLibrary::item(const QString& workshopid) const {
+    for (auto& e : m_entries) {
+        if (e.workshopid == workshopid) {
+            auto m           = e.toVariant();
+            m["description"] = e.description;
+            return m;
+        }
+    }
+    return {};
+}
+
+void WallpaperLibrary::setBusy(bool v) {
+    if (v == m_busy) return;
+    m_busy = v;
+    Q_EMIT busyChanged();
+}
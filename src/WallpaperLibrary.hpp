@@ -0,0 +1,118 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+namespace wekde
+{
+class LibraryWatcher;
+
+// one wallpaper folder, as parsed from its project.json
+struct LibraryEntry {
+    QString     path; // absolute local dir
+    QString     workshopid;
+    qint64      mtime { 0 };         // dir mtime, in seconds
+    qint64      project_mtime { 0 }; // project.json mtime, in ms
+    QString     title;
+    QString     preview;
+    QString     file;
+    QString     type;
+    QString     contentrating;
+    QString     description;
+    QStringList tags;
+    bool        valid { false };
+
+    QVariantMap toVariant() const;
+};
+
+// on-disk index of parsed project.json, keyed by folder path
+class LibraryIndex {
+public:
+    bool load(const QString& file);
+    bool save(const QString& file) const;
+
+    const LibraryEntry* find(const QString& path) const;
+    void                insert(const LibraryEntry&);
+    bool                remove(const QString& path);
+    // drop entries not in alive, return true if any removed
+    bool                retain(const QHash<QString, bool>& alive);
+
+    static QString defaultFile();
+
+private:
+    QHash<QString, LibraryEntry> m_entries;
+};
+
+class WallpaperLibrary : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(int reparsed READ reparsed NOTIFY countChanged)
+    // follow changes on disk after first scan
+    Q_PROPERTY(bool watch READ watch WRITE setWatch NOTIFY watchChanged)
+
+public:
+    WallpaperLibrary(QObject* parent = nullptr);
+    virtual ~WallpaperLibrary();
+
+    bool busy() const { return m_busy; }
+    int  count() const { return m_entries.size(); }
+    // items parsed from disk on last scan, the rest came from index
+    int reparsed() const { return m_reparsed; }
+
+    bool watch() const { return m_watch; }
+    void setWatch(bool);
+
+    // roots: list of dir or list of [dir, fallbacks...], plain path or file url
+    Q_INVOKABLE void        scan(const QVariantList& roots);
+    Q_INVOKABLE QVariantMap item(const QString& workshopid) const;
+
+    // read dirs and parse project.json, use cache when mtime match
+    // reparsed is -1 when only removals happened
+    static QVector<LibraryEntry> ScanRoots(const QVector<QStringList>& roots, LibraryIndex& index,
+                                           int* reparsed = nullptr, QStringList* resolved = nullptr);
+    static LibraryEntry          ParseEntry(const QString& dir);
+    // stat and parse, path is empty when dir not exists
+    static LibraryEntry          LoadEntry(const QString& dir, const LibraryIndex* cache = nullptr,
+                                           bool* fresh = nullptr);
+    static QString               ResolveRoot(const QStringList& candidates);
+
+signals:
+    void busyChanged();
+    void countChanged();
+    void watchChanged();
+    // items: list of map, same fields as Common.wpitem_template
+    void scanned(const QVariantList& items);
+
+    // row level updates from watcher, only after a scan
+    void itemsAdded(const QVariantList& items);
+    void itemsChanged(const QVariantList& items);
+    void itemsRemoved(const QStringList& workshopids);
+
+private:
+    void setBusy(bool);
+    void onScanned(const QVector<LibraryEntry>&, int reparsed, const QStringList& resolved);
+    void onDirty(const QStringList& dirs);
+    // queued dirs in order, the queue is left empty
+    QStringList takeDirty();
+    void onUpdated(const QStringList& dirs, const QVector<LibraryEntry>&);
+    void rescan();
+
+    bool                         m_busy { false };
+    bool                         m_rescan { false };
+    bool                         m_watch { false };
+    bool                         m_updating { false };
+    int                          m_generation { 0 };
+    QStringList                  m_dirty; // queued while a scan or an update is running
+    QSet<QString>                m_dirty_set; // same as m_dirty, a burst is hundreds of dirs
+    QVector<QStringList>         m_roots;
+    QStringList                  m_resolved;
+    QHash<QString, LibraryEntry> m_entries; // path -> entry
+    int                          m_reparsed { 0 };
+    LibraryWatcher*              m_watcher { nullptr };
+};
+} // namespace wekde
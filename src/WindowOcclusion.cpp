@@ -0,0 +1,174 @@
+#include "WindowOcclusion.hpp"
+#include <QLoggingCategory>
+
+Q_LOGGING_CATEGORY(wekdeOcclusion, "wekde.occlusion")
+
+using namespace wekde;
+
+WindowOcclusion::WindowOcclusion(QObject* parent): QObject(parent) {
+    // a window move changes geometry and stacking in separate signals
+    m_update.setSingleShot(true);
+    m_update.setInterval(0);
+    connect(&m_update, &QTimer::timeout, this, &WindowOcclusion::recompute);
+}
+
+WindowOcclusion::~WindowOcclusion() {}
+
+void WindowOcclusion::setModel(QAbstractItemModel* model) {
+    if (model == m_model) return;
+    if (m_model) disconnect(m_model, nullptr, this, nullptr);
+    m_model = model;
+
+    if (m_model) {
+        connect(m_model,
+                &QAbstractItemModel::dataChanged,
+                this,
+                [this](const QModelIndex& tl, const QModelIndex& br, const QList<int>& roles) {
+                    if (! roles.isEmpty()) {
+                        const auto& r     = m_roles;
+                        bool        watch = false;
+                        for (int role : roles) {
+                            watch = watch || role == r.geometry || role == r.activities ||
+                                    role == r.window || role == r.minimized || role == r.hidden ||
+                                    role == r.maximized || role == r.fullscreen || role == r.active;
+                        }
+                        if (! watch) return;
+                    }
+                    const int last = std::min<int>(br.row(), (int)m_rows.size() - 1);
+                    for (int row = tl.row(); row <= last; row++) m_rows[row] = read(row);
+                    schedule();
+                });
+        connect(m_model,
+                &QAbstractItemModel::rowsInserted,
+                this,
+                [this](const QModelIndex& parent, int first, int last) {
+                    if (parent.isValid()) return;
+                    std::vector<Window> rows;
+                    for (int row = first; row <= last; row++) rows.push_back(read(row));
+                    m_rows.insert(m_rows.begin() + first, rows.begin(), rows.end());
+                    schedule();
+                });
+        connect(m_model,
+                &QAbstractItemModel::rowsRemoved,
+                this,
+                [this](const QModelIndex& parent, int first, int last) {
+                    if (parent.isValid()) return;
+                    m_rows.erase(m_rows.begin() + first, m_rows.begin() + last + 1);
+                    schedule();
+                });
+        // sorting by stacking or desktop, rare enough to read again
+        connect(m_model, &QAbstractItemModel::rowsMoved, this, &WindowOcclusion::reload);
+        connect(m_model, &QAbstractItemModel::layoutChanged, this, &WindowOcclusion::reload);
+        connect(m_model, &QAbstractItemModel::modelReset, this, &WindowOcclusion::reload);
+    }
+    reload();
+    Q_EMIT modelChanged();
+}
+
+void WindowOcclusion::setScreenGeometry(const QRectF& v) {
+    if (v == m_screen) return;
+    m_screen = v;
+    schedule();
+    Q_EMIT screenGeometryChanged();
+}
+
+void WindowOcclusion::setActivity(const QString& v) {
+    if (v == m_activity) return;
+    m_activity = v;
+    schedule();
+    Q_EMIT activityChanged();
+}
+
+void WindowOcclusion::resolveRoles() {
+    m_roles = {};
+    if (! m_model) return;
+    const auto names = m_model->roleNames();
+    for (auto it = names.begin(); it != names.end(); it++) {
+        const QByteArray& name = it.value();
+        if (name == "Geometry") m_roles.geometry = it.key();
+        else if (name == "Activities") m_roles.activities = it.key();
+        else if (name == "IsWindow") m_roles.window = it.key();
+        else if (name == "IsMinimized") m_roles.minimized = it.key();
+        else if (name == "IsHidden") m_roles.hidden = it.key();
+        else if (name == "IsMaximized") m_roles.maximized = it.key();
+        else if (name == "IsFullScreen") m_roles.fullscreen = it.key();
+        else if (name == "IsActive") m_roles.active = it.key();
+    }
+    if (m_roles.geometry < 0) qCWarning(wekdeOcclusion) << "model has no Geometry role";
+}
+
+void WindowOcclusion::reload() {
+    resolveRoles();
+    m_rows.clear();
+    if (m_model) {
+        const int count = m_model->rowCount();
+        m_rows.reserve(count);
+        for (int row = 0; row < count; row++) m_rows.push_back(read(row));
+    }
+    schedule();
+}
+
+WindowOcclusion::Window WindowOcclusion::read(int row) const {
+    Window w;
+    if (! m_model) return w;
+    const QModelIndex idx = m_model->index(row, 0);
+    auto get = [this, &idx](int role) { return role < 0 ? QVariant() : m_model->data(idx, role); };
+
+    w.geometry   = get(m_roles.geometry).toRect();
+    w.activities = get(m_roles.activities).toStringList();
+    w.window     = get(m_roles.window).toBool();
+    w.minimized  = get(m_roles.minimized).toBool();
+    w.hidden     = get(m_roles.hidden).toBool();
+    w.maximized  = get(m_roles.maximized).toBool();
+    w.fullscreen = get(m_roles.fullscreen).toBool();
+    w.active     = get(m_roles.active).toBool();
+    return w;
+}
+
+bool WindowOcclusion::visible(const Window& w) const {
+    if (! w.window || w.minimized || w.hidden) return false;
+    // no activities means on all of them
+    return w.activities.isEmpty() || m_activity.isEmpty() || w.activities.contains(m_activity);
+}
+
+void WindowOcclusion::schedule() {
+    if (! m_update.isActive()) m_update.start();
+}
+
+qint64 WindowOcclusion::CoveredArea(const QRegion& windows, const QRect& screen) {
+    qint64 area { 0 };
+    // region rects never overlap
+    for (const QRect& r : windows.intersected(screen)) area += (qint64)r.width() * r.height();
+    return area;
+}
+
+void WindowOcclusion::recompute() {
+    const QRect screen = m_screen.toAlignedRect();
+
+    QRegion windows;
+    int     count { 0 }, maximized { 0 }, fullscreen { 0 }, active { 0 };
+    for (const auto& w : m_rows) {
+        if (! visible(w)) continue;
+        count++;
+        if (w.maximized || w.fullscreen) maximized++;
+        if (w.fullscreen) fullscreen++;
+        if (w.active) active++;
+        if (w.geometry.intersects(screen)) windows += w.geometry;
+    }
+
+    const qint64 total     = (qint64)screen.width() * screen.height();
+    const qreal  uncovered = total > 0 ? 1.0 - (qreal)CoveredArea(windows, screen) / total : 1.0;
+
+    if (uncovered == m_uncovered && count == m_window_count && maximized == m_maximized_count &&
+        fullscreen == m_fullscreen_count && active == m_active_count)
+        return;
+    m_uncovered        = uncovered;
+    m_window_count     = count;
+    m_maximized_count  = maximized;
+    m_fullscreen_count = fullscreen;
+    m_active_count     = active;
+    qCDebug(wekdeOcclusion) << screen << "uncovered" << uncovered << "windows" << count
+                            << "maximized" << maximized << "fullscreen" << fullscreen << "active"
+                            << active;
+    Q_EMIT changed();
+}
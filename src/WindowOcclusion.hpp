@@ -0,0 +1,101 @@
+#pragma once
+#include <QObject>
+#include <QAbstractItemModel>
+#include <QPointer>
+#include <QRectF>
+#include <QRegion>
+#include <QTimer>
+#include <vector>
+
+namespace wekde
+{
+
+// how much of one screen is hidden behind windows, from a TaskManager.TasksModel
+// rows are cached and refreshed on model signals, the union is rebuilt once per event loop turn
+class WindowOcclusion : public QObject {
+    Q_OBJECT
+    // TasksModel, roles are looked up by name so libtaskmanager is not linked
+    Q_PROPERTY(QAbstractItemModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QRectF screenGeometry READ screenGeometry WRITE setScreenGeometry NOTIFY
+                   screenGeometryChanged)
+    // windows on other activities are skipped
+    Q_PROPERTY(QString activity READ activity WRITE setActivity NOTIFY activityChanged)
+
+    // 0 when windows hide the whole screen, 1 when nothing is on it
+    Q_PROPERTY(qreal uncoveredFraction READ uncoveredFraction NOTIFY changed)
+    // not minimized or hidden
+    Q_PROPERTY(int windowCount READ windowCount NOTIFY changed)
+    // maximized or fullscreen
+    Q_PROPERTY(int maximizedCount READ maximizedCount NOTIFY changed)
+    Q_PROPERTY(int fullScreenCount READ fullScreenCount NOTIFY changed)
+    Q_PROPERTY(int activeCount READ activeCount NOTIFY changed)
+
+public:
+    WindowOcclusion(QObject* parent = nullptr);
+    virtual ~WindowOcclusion();
+
+    QAbstractItemModel* model() const { return m_model; }
+    QRectF              screenGeometry() const { return m_screen; }
+    QString             activity() const { return m_activity; }
+    void                setModel(QAbstractItemModel*);
+    void                setScreenGeometry(const QRectF&);
+    void                setActivity(const QString&);
+
+    qreal uncoveredFraction() const { return m_uncovered; }
+    int   windowCount() const { return m_window_count; }
+    int   maximizedCount() const { return m_maximized_count; }
+    int   fullScreenCount() const { return m_fullscreen_count; }
+    int   activeCount() const { return m_active_count; }
+
+    struct Window {
+        QRect       geometry;
+        QStringList activities;
+        bool        window { false };
+        bool        minimized { false };
+        bool        hidden { false };
+        bool        maximized { false };
+        bool        fullscreen { false };
+        bool        active { false };
+    };
+    // covered area of screen in pixels, overlapping windows counted once
+    static qint64 CoveredArea(const QRegion& windows, const QRect& screen);
+
+signals:
+    void modelChanged();
+    void screenGeometryChanged();
+    void activityChanged();
+    void changed();
+
+private:
+    void   resolveRoles();
+    void   reload();
+    Window read(int row) const;
+    bool   visible(const Window&) const;
+    void   schedule();
+    void   recompute();
+
+    QPointer<QAbstractItemModel> m_model;
+    QRectF                       m_screen;
+    QString                      m_activity;
+
+    struct Roles {
+        int geometry { -1 };
+        int activities { -1 };
+        int window { -1 };
+        int minimized { -1 };
+        int hidden { -1 };
+        int maximized { -1 };
+        int fullscreen { -1 };
+        int active { -1 };
+    } m_roles;
+
+    std::vector<Window> m_rows;
+    QTimer              m_update;
+
+    qreal m_uncovered { 1.0 };
+    int   m_window_count { 0 };
+    int   m_maximized_count { 0 };
+    int   m_fullscreen_count { 0 };
+    int   m_active_count { 0 };
+};
+} // namespace wekde
@@ -0,0 +1,109 @@
+#include "FrameClock.hpp"
+#include "Trace.hpp"
+
+#include <QtGui/QScreen>
+#include <QtQuick/QQuickWindow>
+
+using namespace mpv;
+
+namespace
+{
+constexpr int DefaultRefresh { 60 };
+} // namespace
+
+FrameClock* FrameClock::Instance() {
+    // lives until exit, clients may go after static destruction started
+    static FrameClock* clock = new FrameClock;
+    return clock;
+}
+
+FrameClock::FrameClock() {
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &FrameClock::fire);
+}
+
+int FrameClock::Divide(int fps, int refresh) {
+    if (fps <= 0) return 0;
+    if (refresh <= 0) return fps;
+    const int div = std::max(1, refresh / fps);
+    return qRound(double(refresh) / div);
+}
+
+void FrameClock::add(QObject* client, Tick tick) { m_clients.insert(client, Client { std::move(tick) }); }
+
+void FrameClock::remove(QObject* client) { m_clients.remove(client); }
+
+void FrameClock::request(QObject* client, QQuickWindow* window, int fps) {
+    auto it = m_clients.find(client);
+    if (it == m_clients.end()) return;
+    it->fps = fps;
+    if (window != it->window) {
+        it->window = window;
+        watch(window);
+    }
+    if (it->pending) return;
+    it->pending = true;
+    if (! m_timer.isActive()) schedule();
+}
+
+void FrameClock::watch(QQuickWindow* window) {
+    if (! window || m_windows.contains(window)) return;
+    // render thread
+    m_windows.insert(window,
+                     connect(
+                         window,
+                         &QQuickWindow::frameSwapped,
+                         this,
+                         [this]() {
+                             m_phase_ns.store(Trace::NowNs(), std::memory_order_relaxed);
+                         },
+                         Qt::DirectConnection));
+    connect(window, &QObject::destroyed, this, [this, window]() {
+        m_windows.remove(window);
+    });
+}
+
+qint64 FrameClock::periodNs() const {
+    int hz { 0 };
+    for (auto it = m_windows.cbegin(); it != m_windows.cend(); ++it)
+        if (auto* screen = it.key()->screen()) hz = std::max(hz, qRound(screen->refreshRate()));
+    return 1'000'000'000LL / (hz > 0 ? hz : DefaultRefresh);
+}
+
+void FrameClock::schedule() {
+    const qint64 period = periodNs();
+    const qint64 now    = Trace::NowNs();
+    qint64       phase  = m_phase_ns.load(std::memory_order_relaxed);
+    if (! phase || phase > now) phase = now;
+    // just after a swap, the frame asked for then has a whole period to be made
+    const qint64 next = phase + ((now - phase) / period + 1) * period;
+    m_timer.start((int)((next - now + 999'999) / 1'000'000));
+}
+
+void FrameClock::fire() {
+    m_wakeups++;
+    Trace::Instant("clock", "tick");
+    const qint64 now    = Trace::NowNs();
+    const qint64 period = periodNs();
+    bool         waiting { false };
+
+    m_due.clear();
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        Client& c = it.value();
+        if (! c.pending) continue;
+        // half a period early still counts, ticks land a little off
+        if (c.fps > 0 && now - c.last_ns < 1'000'000'000LL / c.fps - period / 2) {
+            waiting = true;
+            continue;
+        }
+        c.pending = false;
+        c.last_ns = now;
+        m_due.push_back(it.key());
+    }
+    for (auto* client : m_due) {
+        auto it = m_clients.constFind(client);
+        if (it != m_clients.cend()) it->tick();
+    }
+    if (waiting) schedule();
+}
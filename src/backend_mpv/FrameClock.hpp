@@ -0,0 +1,63 @@
+#pragma once
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+class QQuickWindow;
+
+namespace mpv
+{
+
+// one timer for all wallpapers of the process instead of one schedule per instance
+// ticks follow the refresh of the fastest screen in use and are phased to its last frame swap,
+// every client due on a tick is served in the same wakeup, nothing runs while no one asks
+// gui thread only
+class FrameClock : public QObject {
+public:
+    using Tick = std::function<void()>;
+
+    static FrameClock* Instance();
+
+    void add(QObject* client, Tick);
+    void remove(QObject* client);
+    // one tick after the next that fps allows, 0 for every tick
+    void request(QObject* client, QQuickWindow* window, int fps);
+
+    // wakeups since start, for a rate
+    quint64 wakeups() const { return m_wakeups; }
+
+    // closest rate at or above fps that is a whole divisor of refresh, 0 stays 0
+    static int Divide(int fps, int refresh);
+
+private:
+    FrameClock();
+
+    struct Client {
+        Tick                  tick;
+        QPointer<QQuickWindow> window;
+        int                   fps { 0 };
+        qint64                last_ns { 0 };
+        bool                  pending { false };
+    };
+
+    void   watch(QQuickWindow*);
+    void   schedule();
+    void   fire();
+    qint64 periodNs() const;
+
+    QHash<QObject*, Client> m_clients;
+    std::vector<QObject*>   m_due;
+    QTimer                  m_timer;
+    quint64                 m_wakeups { 0 };
+
+    // windows whose swaps set the phase
+    QHash<QQuickWindow*, QMetaObject::Connection> m_windows;
+    // written on the render threads
+    std::atomic<qint64>                           m_phase_ns { 0 };
+};
+} // namespace mpv
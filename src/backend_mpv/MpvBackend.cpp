@@ -1,4 +1,9 @@
 #include "MpvBackend.hpp"
+#include "MpvShared.hpp"
+#include "MpvPool.hpp"
+#include "MpvRenderThread.hpp"
+#include "FrameClock.hpp"
+#include "Trace.hpp"
 
 #include <QtGlobal>
 #include <QtCore/QObject>
@@ -13,21 +18,29 @@
 #include <QtGui/QOpenGLFramebufferObject>
 #endif
 #include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLExtraFunctions>
 #include <QtQuick/QQuickWindow>
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
 #include <QtQuick/QQuickOpenGLUtils>
 #endif
 
 #include <QtGui/QOffscreenSurface>
+#include <QtGui/QScreen>
+#include <QtQuick/QSGRendererInterface>
+#include <QtQuick/QSGRenderNode>
 #include <QtQuick/QSGSimpleTextureNode>
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
 #include <QSGTexture>
 #endif
 
+#include <chrono>
 #include <clocale>
+#include <cstring>
 #include <array>
 #include <functional>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <qobjectdefs.h>
 #include <sys/stat.h>
 
@@ -55,7 +68,29 @@ using namespace mpv;
 
 namespace
 {
-void on_mpv_events(void* ctx) { Q_UNUSED(ctx) }
+// reply_userdata of observed properties
+enum ObserveId : uint64_t
+{
+    ObIdle = 1,
+    ObPause,
+    ObAid,
+    ObVolume,
+    ObLogfile,
+    ObDwidth,
+    ObDheight,
+    // source stream, for transcode and decode downscale
+    ObHwdec,
+    ObWidth,
+    ObHeight,
+    ObFps,
+    ObCodec,
+    // playback counters for FrameStats
+    ObDropped,
+    ObDecoderDropped,
+    ObDelayed,
+    ObVfFps,
+    ObCache,
+};
 
 void on_mpv_redraw(void* ctx);
 
@@ -117,13 +152,19 @@ QSGTexture* createTextureFromGl(uint32_t handle, QSize size, QQuickWindow* windo
 } // namespace
 
 bool MpvObject::command(const QVariant& params) {
-    auto* mpv       = m_mpv;
+    auto* mpv = m_mpv;
+    if (! mpv) return false;
     int   errorCode = mpv::qt::get_error(mpv::qt::command(mpv, params));
     return (errorCode >= 0);
 }
 
 bool MpvObject::setProperty(const QString& name, const QVariant& value) {
-    auto* mpv       = m_mpv;
+    auto* mpv = m_mpv;
+    if (! mpv) {
+        // the core is still starting, applied in attachHandle
+        m_pending.append({ 0, false, name, value });
+        return true;
+    }
     int   errorCode = mpv::qt::get_error(mpv::qt::set_property(mpv, name, value));
     _Q_DEBUG() << "Setting property" << name << "to" << value;
     return (errorCode >= 0);
@@ -133,7 +174,7 @@ QVariant MpvObject::getProperty(const QString& name, bool* ok) const {
     auto* mpv = m_mpv;
     if (ok) *ok = false;
 
-    if (name.isEmpty()) {
+    if (name.isEmpty() || ! mpv) {
         return QVariant();
     }
     QVariant  result    = mpv::qt::get_property(mpv, name);
@@ -149,7 +190,45 @@ QVariant MpvObject::getProperty(const QString& name, bool* ok) const {
     return result;
 }
 
+int MpvObject::commandAsync(const QVariant& params) {
+    const int id = m_next_reply++;
+    if (! m_mpv) {
+        // sent in attachHandle under the same id
+        m_pending.append({ id, true, {}, params });
+        return id;
+    }
+    if (mpv::qt::command_async(m_mpv, id, params) < 0) return -1;
+    return id;
+}
+
+int MpvObject::setPropertyAsync(const QString& name, const QVariant& value) {
+    const int id = m_next_reply++;
+    if (! m_mpv) {
+        m_pending.append({ id, false, name, value });
+        return id;
+    }
+    if (mpv::qt::set_property_async(m_mpv, id, name, value) < 0) return -1;
+    _Q_DEBUG() << "Setting property async" << name << "to" << value;
+    return id;
+}
+
+template <typename T>
+int MpvObject::setTypedAsync(const char* name, T value) {
+    const int id = m_next_reply++;
+    if (! m_mpv) {
+        // the generic path has no long, int64_t goes as qlonglong
+        if constexpr (std::is_same_v<T, int64_t>)
+            m_pending.append({ id, false, name, QVariant((qlonglong)value) });
+        else
+            m_pending.append({ id, false, name, QVariant(value) });
+        return id;
+    }
+    if (mpv::qt::set_async(m_mpv, id, name, value) < 0) return -1;
+    return id;
+}
+
 void MpvObject::initCallback() {
+    Trace::Scope trace("mpv", "initCallback");
     QUrl temp(m_source.toString());
     m_source.clear();
     inited = true;
@@ -158,40 +237,232 @@ void MpvObject::initCallback() {
 }
 
 void MpvObject::play() {
+    m_want_play = true;
+    if (m_core) m_core->setPlaying(this, true);
     if (status() != Paused) return;
-    this->setProperty("pause", false);
+    if (setTypedAsync("pause", false) > 0) {
+        // don't wait for the event, a quick pause/play must see this
+        m_paused = false;
+        updateStatus();
+    }
 }
 
 void MpvObject::pause() {
+    m_want_play = false;
+    // others on the core still want to play
+    if (m_core && m_core->setPlaying(this, false)) return;
     if (status() != Playing) return;
-    this->setProperty("pause", true);
+    if (setTypedAsync("pause", true) > 0) {
+        m_paused = true;
+        updateStatus();
+    }
 }
 
 void MpvObject::stop() {
     if (status() == Stopped) return;
-    bool result = this->command(QVariantList { "stop" });
-    if (result) {
+    if (m_core && m_core->users() > 1) {
+        // don't stop the others, go back to an idle core of our own
+        leaveShared({});
+        m_source.clear();
+        Q_EMIT sourceChanged();
+        return;
+    }
+    if (m_core) m_core->setKey({});
+    if (commandAsync(QVariantList { "stop" }) > 0) {
         m_source.clear();
         Q_EMIT sourceChanged();
     }
 }
 
-MpvObject::Status MpvObject::status() const {
-    const bool stopped = getProperty("idle-active").toBool();
-    const bool paused  = getProperty("pause").toBool();
-    return stopped ? Stopped : (paused ? Paused : Playing);
+QVariantMap MpvObject::playbackCounters() const {
+    QVariantMap out;
+    if (m_idle) return out;
+    out.insert("frame-drop-count", m_counters.dropped);
+    out.insert("decoder-frame-drop-count", m_counters.decoder_dropped);
+    out.insert("vo-delayed-frame-count", m_counters.delayed);
+    if (m_detail_readers > 0) {
+        out.insert("estimated-vf-fps", m_counters.vf_fps);
+        out.insert("demuxer-cache-state", m_counters.cache);
+    }
+    return out;
+}
+
+void MpvObject::watchDetail(bool on) {
+    m_detail_readers += on ? 1 : -1;
+    // observeProperties picks it up once the core is there
+    if (! m_mpv) return;
+    if (on && m_detail_readers == 1) {
+        observeDetail();
+    } else if (! on && m_detail_readers == 0) {
+        mpv_unobserve_property(m_mpv, ObVfFps);
+        mpv_unobserve_property(m_mpv, ObCache);
+        m_counters.vf_fps = 0;
+        m_counters.cache.clear();
+    }
 }
 
+void MpvObject::observeDetail() {
+    mpv_observe_property(m_mpv, ObVfFps, "estimated-vf-fps", MPV_FORMAT_DOUBLE);
+    mpv_observe_property(m_mpv, ObCache, "demuxer-cache-state", MPV_FORMAT_NODE);
+}
+
+MpvObject::Status MpvObject::status() const { return m_status; }
+
 QUrl MpvObject::source() const { return m_source; }
 
-bool MpvObject::mute() const {
-    QString aid = getProperty("aid").toString();
-    return aid == "no";
+bool MpvObject::mute() const { return m_mute; }
+
+QString MpvObject::logfile() const { return m_logfile; }
+
+int MpvObject::volume() const { return m_volume; }
+
+void MpvObject::updateStatus() {
+    const Status st = m_idle ? Stopped : (m_paused ? Paused : Playing);
+    if (st == m_status) return;
+    m_status = st;
+    Q_EMIT statusChanged();
 }
 
-QString MpvObject::logfile() const { return getProperty("log-file").toString(); }
+void MpvObject::on_mpv_wakeup(void* ctx) {
+    auto* obj = static_cast<MpvObject*>(ctx);
+    // one queued drain is enough for any number of wakeups
+    if (obj->m_events_pending.exchange(true)) return;
+    QMetaObject::invokeMethod(obj, "handleEvents", Qt::QueuedConnection);
+}
 
-int MpvObject::volume() const { return getProperty("volume").toInt(); }
+void MpvObject::observeProperties() {
+    mpv_observe_property(m_mpv, ObIdle, "idle-active", MPV_FORMAT_FLAG);
+    mpv_observe_property(m_mpv, ObPause, "pause", MPV_FORMAT_FLAG);
+    mpv_observe_property(m_mpv, ObAid, "aid", MPV_FORMAT_STRING);
+    mpv_observe_property(m_mpv, ObVolume, "volume", MPV_FORMAT_DOUBLE);
+    mpv_observe_property(m_mpv, ObLogfile, "log-file", MPV_FORMAT_STRING);
+    mpv_observe_property(m_mpv, ObDwidth, "dwidth", MPV_FORMAT_INT64);
+    mpv_observe_property(m_mpv, ObDheight, "dheight", MPV_FORMAT_INT64);
+    mpv_observe_property(m_mpv, ObHwdec, "hwdec-current", MPV_FORMAT_STRING);
+    mpv_observe_property(m_mpv, ObWidth, "width", MPV_FORMAT_INT64);
+    mpv_observe_property(m_mpv, ObHeight, "height", MPV_FORMAT_INT64);
+    mpv_observe_property(m_mpv, ObFps, "container-fps", MPV_FORMAT_DOUBLE);
+    mpv_observe_property(m_mpv, ObCodec, "video-format", MPV_FORMAT_STRING);
+    mpv_observe_property(m_mpv, ObDropped, "frame-drop-count", MPV_FORMAT_INT64);
+    mpv_observe_property(m_mpv, ObDecoderDropped, "decoder-frame-drop-count", MPV_FORMAT_INT64);
+    mpv_observe_property(m_mpv, ObDelayed, "vo-delayed-frame-count", MPV_FORMAT_INT64);
+    if (m_detail_readers > 0) observeDetail();
+    // log lines go to the trace, the log file is set up separately
+    if (Trace::Enabled()) mpv_request_log_messages(m_mpv, "info");
+}
+
+void MpvObject::handleEvents() {
+    m_events_pending = false;
+    while (m_mpv) {
+        mpv_event* ev = mpv_wait_event(m_mpv, 0);
+        if (ev->event_id == MPV_EVENT_NONE) break;
+        switch (ev->event_id) {
+        case MPV_EVENT_PROPERTY_CHANGE:
+            handlePropertyChange(static_cast<mpv_event_property*>(ev->data), ev->reply_userdata);
+            break;
+        case MPV_EVENT_COMMAND_REPLY:
+        case MPV_EVENT_SET_PROPERTY_REPLY: handleReply(ev); break;
+        case MPV_EVENT_LOG_MESSAGE: {
+            auto* msg = static_cast<mpv_event_log_message*>(ev->data);
+            Trace::Instant("mpv-log", msg->prefix, msg->text);
+            break;
+        }
+        default: break;
+        }
+    }
+    // once per batch, width and height come in separate events
+    if (std::exchange(m_stream_changed, false) && m_first_frame) {
+        // e.g. hwdec fell back to software while playing
+        checkTranscode();
+        applyDecodeScale();
+    }
+}
+
+void MpvObject::handleReply(const mpv_event* ev) {
+    const int id = static_cast<int>(ev->reply_userdata);
+    QVariant  result;
+    QString   error;
+    if (ev->error < 0) {
+        error = QString::fromUtf8(mpv_error_string(ev->error));
+        if (id == m_load_reply) qCWarning(wekdeMpv) << "loadfile failed:" << m_source << error;
+    } else if (ev->event_id == MPV_EVENT_COMMAND_REPLY && ev->data) {
+        result = mpv::qt::node_to_variant(&static_cast<mpv_event_command*>(ev->data)->result);
+    }
+    if (id == m_load_reply) m_load_reply = 0;
+    Q_EMIT asyncFinished(id, result, error);
+}
+
+void MpvObject::handlePropertyChange(const mpv_event_property* prop, uint64_t id) {
+    // format is none when property is unavailable
+    const bool has = prop->format != MPV_FORMAT_NONE && prop->data;
+    switch (id) {
+    case ObIdle:
+        m_idle = has ? *static_cast<int*>(prop->data) : true;
+        updateStatus();
+        break;
+    case ObPause:
+        m_paused = has && *static_cast<int*>(prop->data);
+        updateStatus();
+        break;
+    case ObAid: {
+        // aid is the audio track ID, "no" means no audio track
+        const bool mute = has && std::strcmp(*static_cast<char**>(prop->data), "no") == 0;
+        if (mute == m_mute) break;
+        m_mute = mute;
+        Q_EMIT muteChanged();
+        break;
+    }
+    case ObVolume: {
+        const int volume = has ? qRound(*static_cast<double*>(prop->data)) : 0;
+        if (volume == m_volume) break;
+        m_volume = volume;
+        Q_EMIT volumeChanged();
+        break;
+    }
+    case ObLogfile: {
+        const QString logfile = has ? QString::fromUtf8(*static_cast<char**>(prop->data)) : QString();
+        if (logfile == m_logfile) break;
+        m_logfile = logfile;
+        Q_EMIT logfileChanged();
+        break;
+    }
+    case ObDwidth: m_video_size.setWidth(has ? *static_cast<int64_t*>(prop->data) : 0); break;
+    case ObDheight: m_video_size.setHeight(has ? *static_cast<int64_t*>(prop->data) : 0); break;
+    case ObHwdec: {
+        const char* hwdec = has ? *static_cast<char**>(prop->data) : "";
+        m_stream.hwdec    = *hwdec && std::strcmp(hwdec, "no") != 0;
+        m_stream_changed  = true;
+        break;
+    }
+    case ObWidth:
+        m_stream.size.setWidth(has ? *static_cast<int64_t*>(prop->data) : 0);
+        m_stream_changed = true;
+        break;
+    case ObHeight:
+        m_stream.size.setHeight(has ? *static_cast<int64_t*>(prop->data) : 0);
+        m_stream_changed = true;
+        break;
+    case ObFps:
+        m_stream.fps     = has ? *static_cast<double*>(prop->data) : 0;
+        m_stream_changed = true;
+        break;
+    case ObCodec:
+        m_stream.codec   = has ? QString::fromUtf8(*static_cast<char**>(prop->data)) : QString();
+        m_stream_changed = true;
+        break;
+    case ObDropped: m_counters.dropped = has ? *static_cast<int64_t*>(prop->data) : 0; break;
+    case ObDecoderDropped:
+        m_counters.decoder_dropped = has ? *static_cast<int64_t*>(prop->data) : 0;
+        break;
+    case ObDelayed: m_counters.delayed = has ? *static_cast<int64_t*>(prop->data) : 0; break;
+    case ObVfFps: m_counters.vf_fps = has ? *static_cast<double*>(prop->data) : 0; break;
+    case ObCache:
+        m_counters.cache = has ? mpv::qt::node_to_variant(static_cast<mpv_node*>(prop->data)).toMap()
+                               : QVariantMap();
+        break;
+    default: break;
+    }
+}
 
 void MpvObject::setMute(const bool& mute) {
     // aid is the audio track ID, "no" means no audio track
@@ -202,6 +473,253 @@ void MpvObject::setVolume(const int& volume) { setProperty("volume", volume); }
 
 void MpvObject::setLogfile(const QString& logfile) { setProperty("log-file", logfile); }
 
+void MpvObject::setDisplayMode(DisplayMode mode) {
+    if (mode == m_display_mode) return;
+    m_display_mode = mode;
+    applyDisplayMode();
+    update();
+    Q_EMIT displayModeChanged();
+}
+
+void MpvObject::applyDisplayMode() {
+    // renderers on a core with others scale the decoded frame themselves
+    if (m_core && m_core->users() > 1) return;
+    setTypedAsync("keepaspect", m_display_mode != Scale);
+    setTypedAsync("panscan", m_display_mode == Crop ? 1.0 : 0.0);
+}
+
+void MpvObject::setShared(bool v) {
+    if (v == m_shared) return;
+    if (m_core) {
+        qCWarning(wekdeMpv) << "shared can't change after source is loaded";
+        return;
+    }
+    m_shared = v;
+    applyDisplayMode();
+    syncStats();
+    Q_EMIT sharedChanged();
+}
+
+void MpvObject::setStats(bool v) {
+    if (v == m_stats) return;
+    m_stats = v;
+    syncStats();
+    Q_EMIT statsChanged();
+}
+
+void MpvObject::syncStats() {
+    // a core counts its users, the overlay goes off only when the last one leaves
+    if (m_core) {
+        m_core->setStats(this, m_stats);
+        return;
+    }
+    // shared waits for its core in attachCore
+    const bool want = m_stats && ! m_shared;
+    if (want == m_stats_direct) return;
+    m_stats_direct = want;
+    commandAsync(QVariantList { "script-binding", "stats/display-stats-toggle" });
+}
+
+void MpvObject::setMaxFps(int v) {
+    v = std::max(0, v);
+    if (v == m_max_fps) return;
+    m_max_fps = v;
+    Q_EMIT maxFpsChanged();
+}
+
+void MpvObject::setThreaded(bool v) {
+    if (v == m_threaded) return;
+    m_threaded = v;
+    if (m_threaded) ensureSurface();
+    Q_EMIT threadedChanged();
+}
+
+void MpvObject::setDirect(bool v) {
+    if (v == m_direct) return;
+    m_direct = v;
+    Q_EMIT directChanged();
+}
+
+void MpvObject::setRenderScale(double v) {
+    v = std::clamp(v, 0.25, 1.0);
+    if (qFuzzyCompare(v, m_render_scale)) return;
+    m_render_scale = v;
+    update();
+    Q_EMIT renderScaleChanged();
+}
+
+void MpvObject::setDecodeDownscale(bool v) {
+    if (v == m_decode_downscale) return;
+    m_decode_downscale = v;
+    applyDecodeScale();
+    Q_EMIT decodeDownscaleChanged();
+}
+
+void MpvObject::applyDecodeScale() {
+    if (! m_mpv) return;
+    QString vf;
+    // the others on a shared core may sit on a larger screen
+    if (m_decode_downscale && ! m_idle && ! (m_core && m_core->users() > 1)) {
+        const QSize video  = m_stream.size;
+        const QSize screen = screenTarget().size;
+        // a filter would force hardware frames back to system memory
+        if (! m_stream.hwdec && ! screen.isEmpty() && video.width() > screen.width() &&
+            video.height() > screen.height())
+            vf = QString("lavfi-scale=w=%1:h=%2:force_original_aspect_ratio=increase")
+                     .arg(screen.width())
+                     .arg(screen.height());
+    }
+    if (vf == m_vf) return;
+    _Q_DEBUG() << "decode scale" << (vf.isEmpty() ? QString("off") : vf);
+    m_vf = vf;
+    setPropertyAsync("vf", vf);
+    // less work per frame in h264/hevc, picked up when the decoder is next opened
+    setPropertyAsync("vd-lavc-skiploopfilter", vf.isEmpty() ? "default" : "nonref");
+}
+
+void MpvObject::refreshSharing() {
+    applyDisplayMode();
+    applyDecodeScale();
+    // the renderer picks its path in synchronize
+    update();
+}
+
+void MpvObject::ensureSurface() {
+    if (m_surface || ! m_threaded || ! window()) return;
+    auto* surface = new QOffscreenSurface;
+    surface->setFormat(window()->format());
+    surface->create();
+    // the render thread may drop the last reference
+    m_surface.reset(surface, [](QOffscreenSurface* s) {
+        s->deleteLater();
+    });
+}
+
+void MpvObject::itemChange(ItemChange change, const ItemChangeData& value) {
+    if (change == ItemSceneChange && value.window) ensureSurface();
+    QQuickFramebufferObject::itemChange(change, value);
+}
+
+void MpvObject::setTranscodeDir(const QString& v) {
+    if (v == m_transcode_dir) return;
+    m_transcode_dir = v;
+    Q_EMIT transcodeChanged();
+}
+
+void MpvObject::setTranscodeLimit(int v) {
+    v = std::max(0, v);
+    if (v == m_transcode_limit) return;
+    m_transcode_limit = v;
+    Q_EMIT transcodeChanged();
+}
+
+Transcode::Target MpvObject::screenTarget() const {
+    Transcode::Target t;
+    if (! window()) return t;
+    t.size = (size() * window()->effectiveDevicePixelRatio()).toSize();
+    if (window()->screen()) t.fps = qRound(window()->screen()->refreshRate());
+    return t;
+}
+
+void MpvObject::checkTranscode() {
+    if (m_transcode_dir.isEmpty() || m_transcoded || ! m_source.isLocalFile() || ! m_mpv) return;
+    // hardware decoding copes with anything
+    if (m_stream.hwdec) return;
+
+    const QSize video  = m_stream.size;
+    const auto  screen = screenTarget();
+    if (video.isEmpty() || screen.size.isEmpty()) return;
+
+    if (! Transcode::Heavy(video, m_stream.fps, m_stream.codec, screen)) return;
+    Transcode::Request(m_transcode_dir,
+                       m_source.toLocalFile(),
+                       screen,
+                       Transcode::Fit(video, m_stream.fps, screen),
+                       (qint64)m_transcode_limit * 1024 * 1024);
+}
+
+void MpvObject::requestUpdate() {
+    // mpv drops what is not drawn, the renderer takes the latest frame
+    FrameClock::Instance()->request(this, window(), m_max_fps);
+}
+
+bool MpvObject::attachCore(const QUrl& source) {
+    if (m_switching) {
+        // loaded once the core being made arrives
+        m_switch_source = source;
+        return true;
+    }
+    const QString key   = source.toString();
+    auto          found = MpvCore::Find(key);
+    if (found && found != m_core) {
+        auto client = found->createClient();
+        if (client) {
+            _Q_DEBUG() << "share core for" << key;
+            switchHandle(found, client);
+            return true;
+        }
+    }
+    if (! m_core) {
+        // first use, the private core becomes shareable
+        m_core = std::make_shared<MpvCore>(m_shared_mpv);
+        m_core->subscribe(this);
+        m_core->setPlaying(this, m_want_play);
+        syncStats();
+    } else if (m_core->users() > 1) {
+        // others stay on the old source
+        leaveShared(source);
+        return true;
+    }
+    m_core->setKey(key);
+    return false;
+}
+
+void MpvObject::leaveShared(const QUrl& source) {
+    m_switch_source = source;
+    if (m_switching) return;
+    m_switching = true;
+    // keeps showing the shared core until its own is ready, a waiting spare answers at once
+    MpvPool::Acquire(this, [this](std::shared_ptr<MpvHandle> handle) {
+        m_switching = false;
+        if (! handle) {
+            Q_EMIT coreFailed();
+            return;
+        }
+        switchHandle(std::make_shared<MpvCore>(handle), handle);
+        const QUrl next = std::exchange(m_switch_source, {});
+        if (next.isEmpty()) return;
+        // setSource may have named it already, load it for real now
+        m_source.clear();
+        setSource(next);
+    });
+}
+
+void MpvObject::switchHandle(std::shared_ptr<MpvCore> core, std::shared_ptr<MpvHandle> handle) {
+    leaveCore();
+    // old client handle must go before its core
+    m_shared_mpv = handle;
+    m_mpv        = handle->handle;
+    m_core       = core;
+    m_core->subscribe(this);
+    if (! m_core->setPlaying(this, m_want_play)) mpv::qt::set_async(m_mpv, 0, "pause", true);
+    syncStats();
+
+    // new handle reports current values of observed properties right away
+    observeProperties();
+    mpv_set_wakeup_callback(m_mpv, &MpvObject::on_mpv_wakeup, this);
+    // renderer picks up the handle in synchronize
+    update();
+}
+
+void MpvObject::leaveCore() {
+    if (m_mpv) mpv_set_wakeup_callback(m_mpv, nullptr, nullptr);
+    if (! m_core) return;
+    m_core->unsubscribe(this);
+    // nobody left wants to play
+    if (m_core->users() > 0 && ! m_core->setPlaying(this, false))
+        mpv::qt::set_async(m_core->primary()->handle, 0, "pause", true);
+}
+
 void MpvObject::setSource(const QUrl& source) {
     if (source.isEmpty()) {
         stop();
@@ -214,12 +732,32 @@ void MpvObject::setSource(const QUrl& source) {
         m_source = source;
         return;
     }
-    bool result = this->command(QVariantList {
-        "loadfile",
-        source.isLocalFile() ? QDir::toNativeSeparators(source.toLocalFile()) : source.url() });
-    if (result) {
+    Trace::Scope trace("mpv", "setSource");
+    if (m_shared && attachCore(source)) {
         m_source = source;
         Q_EMIT sourceChanged();
+        m_first_frame = false;
+        return;
+    }
+    // a screen matched copy plays in place of a heavy source
+    const QString cached =
+        source.isLocalFile() ? Transcode::Lookup(m_transcode_dir, source.toLocalFile(), screenTarget())
+                             : QString();
+    m_transcoded = ! cached.isEmpty();
+    if (m_transcoded) _Q_DEBUG() << "play transcoded" << cached << "for" << source;
+    // a switch must not wait for the core to open the file
+    const int reply = commandAsync(QVariantList {
+        "loadfile",
+        m_transcoded          ? cached
+        : source.isLocalFile() ? QDir::toNativeSeparators(source.toLocalFile())
+                               : source.url() });
+    if (reply > 0) {
+        // ends at the first frame
+        if (Trace::Enabled())
+            Trace::Begin("mpv", "load", (quintptr)this, source.toString().toUtf8().constData());
+        m_load_reply = reply;
+        m_source     = source;
+        Q_EMIT sourceChanged();
 
         m_first_frame = false;
     }
@@ -231,15 +769,25 @@ namespace mpv
 class MpvRender : public QObject, public QQuickFramebufferObject::Renderer {
     Q_OBJECT
 public:
-    MpvRender(std::shared_ptr<MpvHandle> mpv, QQuickWindow* win)
-        : m_shared_mpv(mpv), m_mpv(mpv.get()->handle), m_window(win) {}
+    // where a frame goes, the item's fbo or in direct mode the scene graph's own target
+    struct Target {
+        GLuint fbo { 0 };
+        QSize  size;
+        // bottom up rows, the window or the scene graph's render target
+        bool   flip { false };
+    };
+
+    MpvRender(std::shared_ptr<MpvHandle> mpv, QQuickWindow* win, std::shared_ptr<RenderStats> stats)
+        : m_mpv(mpv ? mpv->handle : nullptr), m_window(win), m_stats(stats), m_shared_mpv(mpv) {}
 
     virtual ~MpvRender() {
         _Q_DEBUG() << "destroyed";
-        mpv::qt::command(m_mpv, QVariantList { "stop" });
+        // a shared core keeps playing for the others
+        if (! m_core && m_mpv) mpv::qt::command(m_mpv, QVariantList { "stop" });
 
-        if (m_mpv_context) mpv_render_context_free(m_mpv_context);
-        m_mpv_context = nullptr;
+        releaseContext();
+        if (m_read_fbo && QOpenGLContext::currentContext())
+            QOpenGLContext::currentContext()->functions()->glDeleteFramebuffers(1, &m_read_fbo);
     }
 
     bool Dirty() const { return m_dirty.load(); }
@@ -251,12 +799,12 @@ signals:
 
 public slots:
     // render thread
-    void renderFrame(QOpenGLFramebufferObject* fbo) {
-        mpv_opengl_fbo mpfbo { .fbo             = static_cast<int>(fbo->handle()),
-                               .w               = fbo->width(),
-                               .h               = fbo->height(),
+    void renderFrame(const Target& target) {
+        mpv_opengl_fbo mpfbo { .fbo             = static_cast<int>(target.fbo),
+                               .w               = target.size.width(),
+                               .h               = target.size.height(),
                                .internal_format = 0 };
-        int            flip_y { 0 };
+        int            flip_y { target.flip ? 1 : 0 };
 
         mpv_render_param params[] = {
             { MPV_RENDER_PARAM_OPENGL_FBO, &mpfbo },
@@ -274,7 +822,12 @@ public slots:
     QOpenGLFramebufferObject* createFramebufferObject(const QSize& size) override {
         // QMetaObject::invokeMethod(m_obj, "initCallback", Qt::QueuedConnection);
         // emit m_updater.inited();
-        return QQuickFramebufferObject::Renderer::createFramebufferObject(size);
+        return QQuickFramebufferObject::Renderer::createFramebufferObject(scaledSize(size));
+    }
+
+    QSize scaledSize(const QSize& size) const {
+        if (m_render_scale >= 1.0) return size;
+        return (QSizeF(size) * m_render_scale).toSize().expandedTo(QSize(1, 1));
     }
 
     /*
@@ -284,17 +837,87 @@ public slots:
      * members
      */
     void synchronize(QQuickFramebufferObject* item) override {
-        MpvObject* mpv_obj = static_cast<MpvObject*>(item);
+        Trace::Scope trace("mpv", "synchronize");
+        MpvObject*   mpv_obj = static_cast<MpvObject*>(item);
+
+        // item moved to another core, drop handle before core
+        if (mpv_obj->m_shared_mpv != m_shared_mpv) {
+            releaseContext();
+            m_shared_mpv = mpv_obj->m_shared_mpv;
+            // null until the pool hands out a core
+            m_mpv        = m_shared_mpv ? m_shared_mpv->handle : nullptr;
+            m_core       = mpv_obj->m_core;
+        } else if (mpv_obj->m_core != m_core) {
+            // private core became shareable, our context stays
+            m_core = mpv_obj->m_core;
+        }
+        m_item         = mpv_obj;
+        m_display_mode = mpv_obj->m_display_mode;
+        m_video_size   = mpv_obj->m_video_size;
+        // the ring is only drawn by our own node, direct draws in the scene graph's pass
+        m_threaded =
+            mpv_obj->m_threaded && mpv_obj->m_paint_node && ! mpv_obj->m_paint_direct;
+        m_surface      = mpv_obj->m_surface;
+        if (! qFuzzyCompare(m_render_scale, mpv_obj->m_render_scale)) {
+            m_render_scale = mpv_obj->m_render_scale;
+            invalidateFramebufferObject();
+        }
+        // the item has been told, the next frame may post again
+        m_posted       = false;
+
+        const QSize target =
+            scaledSize((mpv_obj->size() * m_window->effectiveDevicePixelRatio()).toSize());
+
+        // alone on the core mpv draws straight to our target, the decode texture is for others
+        const bool sole = ! m_core || m_core->users() <= 1;
+        if (sole != m_sole) {
+            m_sole = sole;
+            if (sole) {
+                releaseDecode();
+                // back to the render thread, it makes a render context of its own
+                if (m_threaded && m_mpv_context) {
+                    mpv_render_context_free(m_mpv_context);
+                    m_mpv_context = nullptr;
+                }
+            } else {
+                // others copy the decode texture, only the scene graph's context hands it out
+                m_thread.reset();
+            }
+            setDirty(true);
+        }
+
+        bool new_frame = Dirty();
+        if (m_core) {
+            std::lock_guard lock(m_core->mutex());
+            auto&           frame = m_core->frame();
+            frame.targets.insert(this, target);
+            if (! frame.leader) {
+                frame.leader  = this;
+                frame.context = QOpenGLContext::currentContext();
+            }
+            if (frame.leader != this) new_frame = frame.serial != m_serial;
+        }
 
-        if (m_mpv_context == nullptr) {
-            // mpv_set_wakeup_callback(m_mpv_handle, on_mpv_events, nullptr);
-            if (CreateMpvContex(m_mpv, &m_mpv_context) >= 0) {
+        if (m_mpv_context == nullptr && ! m_thread && m_mpv && (! m_core || isLeader())) {
+            if (m_sole && m_threaded && startThread()) {
+                _Q_DEBUG() << "render on own thread";
+            } else if (CreateMpvContex(m_mpv, &m_mpv_context) >= 0) {
                 mpv_render_context_set_update_callback(m_mpv_context, on_mpv_redraw, this);
-                Q_EMIT this->inited();
+            } else if (m_core) {
+                std::lock_guard lock(m_core->mutex());
+                m_core->frame().leader = nullptr;
             }
         }
+        if (m_thread) {
+            m_thread->setTarget(target);
+            m_thread->setMaxFps(mpv_obj->m_max_fps);
+        }
+        if (! m_inited && (m_mpv_context || m_thread || m_core)) {
+            m_inited = true;
+            Q_EMIT this->inited();
+        }
 
-        if (Dirty()) {
+        if (new_frame) {
             mpv_obj->checkAndEmitFirstFrame();
         }
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
@@ -305,25 +928,468 @@ public slots:
     }
 
     void render() override {
-        if (setDirty(false)) {
-            QOpenGLFramebufferObject* fbo = framebufferObject();
-            renderFrame(fbo);
+        const QOpenGLFramebufferObject* fbo = framebufferObject();
+        renderTo({ fbo->handle(), fbo->size(), false }, false);
+    }
+
+    // force draws even without a new frame, a direct target is cleared every frame
+    void renderTo(const Target& target, bool force) {
+        Trace::Scope trace("mpv", "render");
+        const auto   start = std::chrono::steady_clock::now();
+        if (m_core && ! m_sole) {
+            renderShared(target);
+        } else if (m_mpv_context && (setDirty(false) || force)) {
+            renderFrame(target);
+        } else
+            return;
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-            QQuickOpenGLUtils::resetOpenGLState();
+        QQuickOpenGLUtils::resetOpenGLState();
 #else
-            m_window->resetOpenGLState();
+        m_window->resetOpenGLState();
 #endif
-        }
+        m_stats->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+        m_stats->texture_bytes.store(textureBytes(), std::memory_order_relaxed);
     }
 
+    // mpv thread, from the update callback
+    void redraw() {
+        m_stats->redraws.fetch_add(1, std::memory_order_relaxed);
+        Trace::Instant("mpv", "redraw");
+        setDirty(true);
+        post();
+    }
+
+    // render thread, a frame is ready in the ring
+    void frameReady() {
+        setDirty(true);
+        post();
+    }
+
+    // direct mode, ask the item for another synchronize
+    void requestSync() { post(); }
+
+    bool threaded() const { return (bool)m_thread; }
+    // threaded mode, the newest frame of the ring, in synchronize
+    MpvRenderThread::Frame acquireFrame() {
+        // frame times are recorded on the thread
+        setDirty(false);
+        m_stats->texture_bytes.store(textureBytes(), std::memory_order_relaxed);
+        return m_thread->acquire();
+    }
+
+    // direct mode fallback, an fbo of our own shown as a texture
+    QOpenGLFramebufferObject* renderOwn(const QSize& size) {
+        const bool fresh = ! m_own || m_own->size() != size;
+        if (fresh) m_own = std::make_unique<QOpenGLFramebufferObject>(size);
+        renderTo({ m_own->handle(), size, false }, fresh);
+        return m_own.get();
+    }
+    void releaseOwn() { m_own.reset(); }
+
 private:
+    // one queued update until the next synchronize, the item redraws once per frame anyway
+    void post() {
+        if (! m_posted.exchange(true)) Q_EMIT mpvRedraw();
+    }
+
+    bool startThread() {
+        if (! m_surface) return false;
+        mpv_handle* mpv = m_mpv;
+        auto        thread = std::make_unique<MpvRenderThread>(
+            [mpv]() -> mpv_render_context* {
+                mpv_render_context* ctx { nullptr };
+                return CreateMpvContex(mpv, &ctx) >= 0 ? ctx : nullptr;
+            },
+            QOpenGLContext::currentContext(),
+            m_surface,
+            m_stats);
+        thread->setOnFrame([this]() {
+            frameReady();
+        });
+        if (! thread->launch()) return false;
+        m_thread = std::move(thread);
+        return true;
+    }
+
+    GLuint readFbo() {
+        if (! m_read_fbo)
+            QOpenGLContext::currentContext()->functions()->glGenFramebuffers(1, &m_read_fbo);
+        return m_read_fbo;
+    }
+
+    bool isLeader() {
+        std::lock_guard lock(m_core->mutex());
+        return m_core->frame().leader == this;
+    }
+
+    // leader decodes into a video sized texture, everyone scales the newest to its own fbo
+    void renderShared(const Target& target) {
+        auto* gl = QOpenGLContext::currentContext()->extraFunctions();
+
+        if (m_mpv_context) {
+            if (setDirty(false) || m_front < 0) renderDecode(target.size);
+            if (m_front >= 0) blit(m_decode[m_front]->handle(), m_decode[m_front]->size(), target);
+            return;
+        }
+
+        // held until our read fence is published, the leader can't reuse the buffer meanwhile
+        std::lock_guard lock(m_core->mutex());
+        auto&           frame = m_core->frame();
+        if (frame.front < 0 || ! frame.context ||
+            ! QOpenGLContext::areSharing(frame.context, QOpenGLContext::currentContext()))
+            return;
+        auto& buffer = frame.buffers[frame.front];
+        if (! buffer.texture) return;
+        if (buffer.fence) gl->glWaitSync(buffer.fence, 0, GL_TIMEOUT_IGNORED);
+        if (m_read_generation != buffer.generation) {
+            gl->glBindFramebuffer(GL_FRAMEBUFFER, readFbo());
+            gl->glFramebufferTexture2D(
+                GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, buffer.texture, 0);
+            m_read_generation = buffer.generation;
+        }
+        blit(m_read_fbo, buffer.size, target);
+
+        GLsync& read = buffer.reads[this];
+        if (read) gl->glDeleteSync(read);
+        read = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        // fence must reach the gpu before the leader waits on it
+        gl->glFlush();
+        m_serial = frame.serial;
+    }
+
+    // leader, draw the next frame into the buffer that is not the newest
+    void renderDecode(const QSize& own) {
+        auto*     gl   = QOpenGLContext::currentContext()->extraFunctions();
+        const int back = m_front == 0 ? 1 : 0;
+
+        QHash<const void*, GLsync> reads;
+        {
+            std::lock_guard lock(m_core->mutex());
+            std::swap(reads, m_core->frame().buffers[back].reads);
+        }
+        // followers may still copy the frame drawn here before
+        for (GLsync read : std::as_const(reads)) {
+            gl->glWaitSync(read, 0, GL_TIMEOUT_IGNORED);
+            gl->glDeleteSync(read);
+        }
+
+        const QSize size  = decodeSize(own);
+        auto&       fbo   = m_decode[back];
+        const bool  fresh = ! fbo || fbo->size() != size;
+        if (fresh) fbo = std::make_unique<QOpenGLFramebufferObject>(size);
+        renderFrame({ fbo->handle(), size, false });
+        {
+            std::lock_guard lock(m_core->mutex());
+            auto&           frame  = m_core->frame();
+            auto&           buffer = frame.buffers[back];
+            if (buffer.fence) gl->glDeleteSync(buffer.fence);
+            buffer.fence = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            buffer.size  = size;
+            if (fresh) {
+                buffer.texture    = fbo->texture();
+                buffer.generation = ++frame.generation;
+            }
+            frame.front = back;
+            m_serial    = ++frame.serial;
+        }
+        m_front = back;
+        // fence must reach the gpu before others wait on it
+        gl->glFlush();
+        m_core->notify(m_item);
+    }
+
+    // leader frees both buffers and what followers left on them, a follower only its reads
+    void releaseDecode() {
+        auto* context = QOpenGLContext::currentContext();
+        auto* gl      = context ? context->extraFunctions() : nullptr;
+        m_decode[0].reset();
+        m_decode[1].reset();
+        m_front           = -1;
+        m_read_generation = 0;
+        if (! m_core) return;
+
+        std::lock_guard lock(m_core->mutex());
+        auto&           frame = m_core->frame();
+        if (frame.leader != this) {
+            for (auto& buffer : frame.buffers) {
+                GLsync read = buffer.reads.take(this);
+                if (read && gl) gl->glDeleteSync(read);
+            }
+            return;
+        }
+        for (auto& buffer : frame.buffers) {
+            if (gl) {
+                if (buffer.fence) gl->glDeleteSync(buffer.fence);
+                for (GLsync read : std::as_const(buffer.reads)) gl->glDeleteSync(read);
+            }
+            buffer = {};
+        }
+        frame.front = -1;
+    }
+
+    // scale to own fbo with own display mode
+    void blit(GLuint src_fbo, const QSize& src_size, const Target& dst) {
+        auto*       gl = QOpenGLContext::currentContext()->extraFunctions();
+        const QSize dst_size { dst.size };
+        QRect       src(QPoint(0, 0), src_size);
+        QRect       out(QPoint(0, 0), dst_size);
+
+        gl->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst.fbo);
+        if (m_display_mode == MpvObject::Aspect) {
+            const QSize fit = src_size.scaled(dst_size, Qt::KeepAspectRatio);
+            out = QRect(QPoint((dst_size.width() - fit.width()) / 2,
+                               (dst_size.height() - fit.height()) / 2),
+                        fit);
+            gl->glClearColor(0, 0, 0, 1);
+            gl->glClear(GL_COLOR_BUFFER_BIT);
+        } else if (m_display_mode == MpvObject::Crop) {
+            const QSize crop = dst_size.scaled(src_size, Qt::KeepAspectRatio);
+            src = QRect(QPoint((src_size.width() - crop.width()) / 2,
+                               (src_size.height() - crop.height()) / 2),
+                        crop);
+        }
+        // rows of a bottom up target run the other way
+        const int y0 = dst.flip ? dst_size.height() - out.y() : out.y();
+        const int y1 = dst.flip ? y0 - out.height() : y0 + out.height();
+        gl->glBindFramebuffer(GL_READ_FRAMEBUFFER, src_fbo);
+        gl->glBlitFramebuffer(src.x(), src.y(), src.x() + src.width(), src.y() + src.height(),
+                              out.x(), y0, out.x() + out.width(), y1,
+                              GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    }
+
+    // rgba8 estimate, mpv's own intermediate textures are not visible here
+    qint64 textureBytes() const {
+        auto bytes = [](const QSize& s) {
+            return (qint64)s.width() * s.height() * 4;
+        };
+        qint64 total { 0 };
+        if (const auto* fbo = framebufferObject()) total += bytes(fbo->size());
+        for (const auto& fbo : m_decode)
+            if (fbo) total += bytes(fbo->size());
+        if (m_own) total += bytes(m_own->size());
+        if (m_thread) total += m_thread->textureBytes();
+        return total;
+    }
+
+    // video size, but never more than the largest screen needs
+    QSize decodeSize(const QSize& own) {
+        QSize target;
+        {
+            std::lock_guard lock(m_core->mutex());
+            target = m_core->maxTarget();
+        }
+        target          = target.expandedTo(own);
+        const QSize src = m_video_size.isEmpty() ? target : m_video_size;
+        QSize       out = src.scaled(target, Qt::KeepAspectRatioByExpanding);
+        if (out.width() > src.width()) out = src;
+        return out.expandedTo(QSize(1, 1));
+    }
+
+    // gl context is current
+    void releaseContext() {
+        // frees its render context on its own thread
+        m_thread.reset();
+        if (m_mpv_context) mpv_render_context_free(m_mpv_context);
+        m_mpv_context = nullptr;
+        releaseDecode();
+        if (! m_core) return;
+
+        bool was_leader { false };
+        {
+            std::lock_guard lock(m_core->mutex());
+            auto&           frame = m_core->frame();
+            frame.targets.remove(this);
+            if (frame.leader == this) {
+                was_leader    = true;
+                frame.leader  = nullptr;
+                frame.context = nullptr;
+            }
+        }
+        // let a follower take over
+        if (was_leader) m_core->notify(m_item);
+    }
+
     mpv_render_context* m_mpv_context { nullptr };
     mpv_handle*         m_mpv { nullptr };
     QQuickWindow*       m_window { nullptr };
+    const QObject*      m_item { nullptr };
 
+    std::shared_ptr<RenderStats> m_stats;
+    bool                m_inited { false };
+
+    std::shared_ptr<MpvCore>   m_core { nullptr };
     std::shared_ptr<MpvHandle> m_shared_mpv { nullptr };
 
+    // shared mode, only while others are on the core too
+    bool                                                     m_sole { true };
+    std::array<std::unique_ptr<QOpenGLFramebufferObject>, 2> m_decode;
+    // leader, newest of m_decode
+    int                                                      m_front { -1 };
+    GLuint                                                   m_read_fbo { 0 };
+    // follower, buffer generation attached to m_read_fbo
+    quint64                                                  m_read_generation { 0 };
+    quint64                                                  m_serial { 0 };
+    MpvObject::DisplayMode                    m_display_mode { MpvObject::Aspect };
+    QSize                                     m_video_size;
+
+    double                                    m_render_scale { 1.0 };
+
+    // direct mode fallback
+    std::unique_ptr<QOpenGLFramebufferObject> m_own;
+
+    // threaded mode
+    std::unique_ptr<MpvRenderThread>   m_thread;
+    std::shared_ptr<QOffscreenSurface> m_surface;
+    bool                               m_threaded { false };
+
     std::atomic<bool> m_dirty { false };
+    std::atomic<bool> m_posted { false };
+};
+
+// mpv draws straight into the scene graph's render target during the scene graph's own pass
+// needs the item to cover the window, mpv always fills the whole viewport
+class MpvRenderNode : public QSGRenderNode {
+public:
+    explicit MpvRenderNode(MpvRender* render): m_render(render) {}
+
+    StateFlags changedStates() const override {
+        return DepthState | StencilState | ScissorState | ColorState | BlendState | CullState |
+               ViewportState | RenderTargetState;
+    }
+    // not depth aware, the batch renderer then draws back to front and items above stay above
+    RenderingFlags flags() const override { return BoundedRectRendering | OpaqueRendering; }
+    QRectF         rect() const override { return m_rect; }
+
+    void render(const RenderState*) override {
+        // an ancestor started to fade, switch to the texture on the next synchronize
+        if (inheritedOpacity() < 1.0) m_render->requestSync();
+        GLint fbo { 0 };
+        QOpenGLContext::currentContext()->functions()->glGetIntegerv(GL_FRAMEBUFFER_BINDING, &fbo);
+        m_render->renderTo({ (GLuint)fbo, m_target, true }, true);
+    }
+
+    QRectF m_rect;
+    QSize  m_target;
+
+private:
+    MpvRender* m_render;
+};
+
+// our node in threaded and direct mode, the item's own fbo is never made
+// threaded: the newest texture of the render thread's ring, drawn as it is
+// direct: the render node while the item is opaque and fills the window
+// else, also while a shared core renders in the scene graph: an fbo of our own as a texture
+// one renderer for all, a new render context would drop the video
+class MpvNode : public QSGNode {
+public:
+    MpvNode(MpvRender* render, QQuickWindow* window): m_render(render), m_window(window) {}
+    ~MpvNode() {
+        // children first, they point to the renderer
+        removeAllChildNodes();
+        delete m_direct;
+        delete m_texture;
+    }
+
+    void sync(MpvObject* item) {
+        m_render->synchronize(item);
+        const qreal  dpr  = m_window->effectiveDevicePixelRatio();
+        const QRectF rect = item->boundingRect();
+
+        if (m_render->threaded()) {
+            dropDirect();
+            m_render->releaseOwn();
+            const auto frame = m_render->acquireFrame();
+            // nothing drawn yet, keep what was shown before
+            if (frame.texture)
+                showTexture(frame.texture, frame.texture_size, frame.size, rect);
+            return;
+        }
+
+        if (item->m_paint_direct && Direct(item)) {
+            if (m_texture) {
+                removeChildNode(m_texture);
+                delete m_texture;
+                m_texture = nullptr;
+                m_render->releaseOwn();
+            }
+            if (! m_direct) {
+                m_direct = new MpvRenderNode(m_render.get());
+                appendChildNode(m_direct);
+            }
+            m_direct->m_rect   = rect;
+            m_direct->m_target = (m_window->size() * dpr).toSize();
+            m_direct->markDirty(QSGNode::DirtyMaterial);
+            return;
+        }
+
+        dropDirect();
+        const QSize size =
+            m_render->scaledSize((rect.size() * dpr).toSize()).expandedTo(QSize(1, 1));
+        auto*       fbo  = m_render->renderOwn(size);
+        showTexture(fbo->texture(), size, size, rect);
+    }
+
+private:
+    void dropDirect() {
+        if (! m_direct) return;
+        removeChildNode(m_direct);
+        delete m_direct;
+        m_direct = nullptr;
+    }
+
+    // the used part of a gl texture over rect
+    void showTexture(GLuint id, const QSize& texture_size, const QSize& used, const QRectF& rect) {
+        if (! m_texture) {
+            m_texture = new QSGSimpleTextureNode;
+            // wrappers are ours, a ring texture comes back every third frame
+            m_texture->setOwnsTexture(false);
+            appendChildNode(m_texture);
+        }
+        m_texture->setTexture(wrap(id, texture_size));
+        m_texture->setSourceRect(QRectF(QPointF(0, 0), used));
+        m_texture->setRect(rect);
+        m_texture->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    QSGTexture* wrap(GLuint id, const QSize& size) {
+        for (const auto& w : m_wraps)
+            if (w.texture && w.id == id && w.size == size) return w.texture.get();
+        // replaced right away in showTexture, the node never draws the old one again
+        auto& w     = m_wraps[m_next_wrap];
+        m_next_wrap = (m_next_wrap + 1) % (int)m_wraps.size();
+        w.id        = id;
+        w.size      = size;
+        w.texture.reset(createTextureFromGl(id, size, m_window));
+        return w.texture.get();
+    }
+
+    static bool Direct(const MpvObject* item) {
+        // a smaller frame needs a texture to be stretched from
+        if (item->renderScale() < 1.0) return false;
+        const QQuickWindow* window = item->window();
+        const QRect         scene  = item->mapRectToScene(item->boundingRect()).toAlignedRect();
+        if (scene != QRect(QPoint(0, 0), window->size())) return false;
+        // the scene graph only tells the render node, and only at render time
+        for (auto* it = item; it; it = it->parentItem())
+            if (it->opacity() < 1.0) return false;
+        return true;
+    }
+
+    struct Wrap {
+        GLuint                      id { 0 };
+        QSize                       size;
+        std::unique_ptr<QSGTexture> texture;
+    };
+
+    std::unique_ptr<MpvRender> m_render;
+    QQuickWindow*              m_window;
+    MpvRenderNode*             m_direct { nullptr };
+    QSGSimpleTextureNode*      m_texture { nullptr };
+    // one per ring slot
+    std::array<Wrap, 3>        m_wraps;
+    int                        m_next_wrap { 0 };
 };
 
 } // namespace mpv
@@ -331,32 +1397,67 @@ private:
 namespace
 {
 void on_mpv_redraw(void* ctx) {
-    auto* mpv = static_cast<mpv::MpvRender*>(ctx);
-    mpv->setDirty(true);
-    Q_EMIT mpv->mpvRedraw();
+    static_cast<mpv::MpvRender*>(ctx)->redraw();
 }
 } // namespace
 
-MpvObject::MpvObject(QQuickItem* parent)
-    : QQuickFramebufferObject(parent), m_shared_mpv(std::make_shared<MpvHandle>(mpv_create())) {
-    m_mpv = m_shared_mpv.get()->handle;
+MpvObject::MpvObject(QQuickItem* parent): QQuickFramebufferObject(parent) {
+    m_startup.start();
+    FrameClock::Instance()->add(this, [this]() {
+        update();
+    });
+    // emitted from the render thread
+    connect(this, &MpvObject::firstFrame, this, &MpvObject::checkTranscode, Qt::QueuedConnection);
+    connect(this, &MpvObject::firstFrame, this, &MpvObject::applyDecodeScale, Qt::QueuedConnection);
+
+    // mpv_initialize takes tens of ms, don't block plasmashell startup on it
+    MpvPool::Acquire(this, [this](std::shared_ptr<MpvHandle> handle) {
+        if (handle)
+            attachHandle(handle);
+        else
+            Q_EMIT coreFailed();
+    });
+}
 
-    if (! m_mpv) _Q_DEBUG() << "could not create mpv context";
-    mpv_set_option_string(m_mpv, "terminal", "no");
-    mpv_set_option_string(m_mpv, "msg-level", "all=info");
-    if (mpv_initialize(m_mpv) < 0) _Q_DEBUG() << "could not initialize mpv context";
+void MpvObject::attachHandle(std::shared_ptr<MpvHandle> handle) {
+    m_core_ms    = (int)m_startup.elapsed();
+    m_shared_mpv = handle;
+    m_mpv        = handle->handle;
 
-    mpv_set_option_string(m_mpv, "config", "no");
-    mpv_set_option_string(m_mpv, "hwdec", "auto");
-    mpv_set_option_string(m_mpv, "vo", "libmpv");
-    mpv_set_option_string(m_mpv, "loop", "inf");
+    observeProperties();
+    mpv_set_wakeup_callback(m_mpv, &MpvObject::on_mpv_wakeup, this);
+    // in call order, sync and async calls may depend on each other
+    for (const auto& p : std::as_const(m_pending)) {
+        if (p.id == 0) {
+            setProperty(p.name, p.value);
+            continue;
+        }
+        const int err = p.command
+                            ? mpv::qt::command_async(m_mpv, p.id, p.value)
+                            : mpv::qt::set_property_async(m_mpv, p.id, p.name, p.value);
+        if (err < 0) Q_EMIT asyncFinished(p.id, {}, QString::fromUtf8(mpv_error_string(err)));
+    }
+    m_pending.clear();
+    applyDisplayMode();
+    // renderer picks up the handle in synchronize
+    update();
 }
 
-MpvObject::~MpvObject() {}
+MpvObject::~MpvObject() {
+    FrameClock::Instance()->remove(this);
+    // handle may outlive us in the renderer
+    leaveCore();
+}
 
 void MpvObject::checkAndEmitFirstFrame() {
     if (! m_first_frame) {
         m_first_frame = true;
+        Trace::End("mpv", "load", (quintptr)this);
+        if (m_startup_ms < 0) {
+            m_startup_ms = (int)m_startup.elapsed();
+            _Q_DEBUG() << "first frame" << m_startup_ms << "ms after creation, core ready at"
+                       << m_core_ms << "ms";
+        }
         Q_EMIT firstFrame();
     }
 }
@@ -367,12 +1468,28 @@ QQuickFramebufferObject::Renderer* MpvObject::createRenderer() const {
 #endif
     window()->setPersistentSceneGraph(true);
 
-    auto* render = new MpvRender(m_shared_mpv, window());
+    auto* render = new MpvRender(m_shared_mpv, window(), m_render_stats);
 
     // Use Queued signal to update at gui thread
-    connect(render, &MpvRender::mpvRedraw, this, &MpvObject::update, Qt::QueuedConnection);
+    connect(render, &MpvRender::mpvRedraw, this, &MpvObject::requestUpdate, Qt::QueuedConnection);
     connect(render, &MpvRender::inited, this, &MpvObject::initCallback, Qt::QueuedConnection);
     return render;
 }
 
+QSGNode* MpvObject::updatePaintNode(QSGNode* old, UpdatePaintNodeData* data) {
+    // kept for the life of the node, switching would need a new render context
+    if (! old) {
+        const bool gl =
+            window()->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL;
+        m_paint_node   = gl && (m_threaded || m_direct);
+        m_paint_direct = gl && m_direct;
+    }
+    if (! m_paint_node) return QQuickFramebufferObject::updatePaintNode(old, data);
+
+    auto* node = static_cast<MpvNode*>(old);
+    if (! node) node = new MpvNode(static_cast<MpvRender*>(createRenderer()), window());
+    node->sync(this);
+    return node;
+}
+
 #include "MpvBackend.moc"
@@ -7,32 +7,108 @@
 #include <QtQuick/QQuickItem>
 #include <QtQuick/QQuickFramebufferObject>
 #include <QtCore/QLoggingCategory>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTimer>
 #include <memory>
+#include <atomic>
+#include <array>
+#include <algorithm>
 
 #include "qthelper.hpp"
+#include "MpvTranscode.hpp"
 
 Q_DECLARE_LOGGING_CATEGORY(wekdeMpv)
 
+class QOffscreenSurface;
+
 namespace mpv
 {
 
 struct MpvHandle {
-    MpvHandle(mpv_handle* mpv): handle(mpv) {}
-    ~MpvHandle() { mpv_terminate_destroy(handle); }
+    // client handles only detach, the core lives on with its other handles
+    MpvHandle(mpv_handle* mpv, bool client = false): handle(mpv), client(client) {}
+    ~MpvHandle() {
+        if (client)
+            mpv_destroy(handle);
+        else
+            mpv_terminate_destroy(handle);
+    }
     mpv_handle* handle;
+    bool        client;
 };
 
 class MpvRender;
+class MpvNode;
+class MpvCore;
+
+// written by the renderer after each drawn frame, readable from any thread
+struct RenderStats {
+    // 125us wide, the last bucket takes everything slower
+    static constexpr qint64 BucketNs { 125'000 };
+    static constexpr int    Buckets { 256 };
+
+    std::atomic<quint64> frames { 0 };
+    std::atomic<qint64>  last_ns { 0 };
+    // update callbacks from mpv, not every one ends in a drawn frame
+    std::atomic<quint64> redraws { 0 };
+    // bytes of fbos and textures the renderer holds
+    std::atomic<qint64>  texture_bytes { 0 };
+
+    // histogram and sums are only kept while someone reads them
+    // all only grow, each reader takes its own deltas
+    std::atomic<int>                            readers { 0 };
+    std::array<std::atomic<quint32>, Buckets>   histogram {};
+    std::atomic<qint64>                         sum_ns { 0 };
+    // frames in the open last bucket
+    std::atomic<qint64>                         slow_ns { 0 };
+
+    void record(qint64 ns) {
+        last_ns.store(ns, std::memory_order_relaxed);
+        frames.fetch_add(1, std::memory_order_relaxed);
+        if (readers.load(std::memory_order_relaxed) == 0) return;
+        const int i = (int)std::min<qint64>(ns / BucketNs, Buckets - 1);
+        histogram[i].fetch_add(1, std::memory_order_relaxed);
+        sum_ns.fetch_add(ns, std::memory_order_relaxed);
+        if (i == Buckets - 1) slow_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+};
 
 class MpvObject : public QQuickFramebufferObject {
     Q_OBJECT
     Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
     Q_PROPERTY(Status status READ status NOTIFY statusChanged)
-    Q_PROPERTY(bool mute READ mute WRITE setMute)
-    Q_PROPERTY(QString logfile READ logfile WRITE setLogfile)
-    Q_PROPERTY(int volume READ volume WRITE setVolume)
+    Q_PROPERTY(bool mute READ mute WRITE setMute NOTIFY muteChanged)
+    Q_PROPERTY(QString logfile READ logfile WRITE setLogfile NOTIFY logfileChanged)
+    Q_PROPERTY(int volume READ volume WRITE setVolume NOTIFY volumeChanged)
+    Q_PROPERTY(DisplayMode displayMode READ displayMode WRITE setDisplayMode NOTIFY displayModeChanged)
+    // share one mpv core and decode with other instances of the same source
+    // set before the source is loaded
+    Q_PROPERTY(bool shared READ shared WRITE setShared NOTIFY sharedChanged)
+    // mpv stats overlay, on a shared core it stays while any item wants it
+    Q_PROPERTY(bool stats READ stats WRITE setStats NOTIFY statsChanged)
+    // cap on drawn frames per second, 0 draws every frame mpv offers
+    Q_PROPERTY(int maxFps READ maxFps WRITE setMaxFps NOTIFY maxFpsChanged)
+    // screen matched copies of heavy videos that decode in software, empty disables
+    Q_PROPERTY(QString transcodeDir READ transcodeDir WRITE setTranscodeDir NOTIFY transcodeChanged)
+    // MiB kept in transcodeDir
+    Q_PROPERTY(int transcodeLimit READ transcodeLimit WRITE setTranscodeLimit NOTIFY transcodeChanged)
+    // ms from creation to the first frame, -1 before it
+    Q_PROPERTY(int startupMs READ startupMs NOTIFY firstFrame)
+    // mpv draws on its own thread, the scene graph draws its newest texture without an item fbo
+    // OpenGL only, picked when the item is first drawn; a core shared with others renders in
+    // the scene graph until it is alone again
+    Q_PROPERTY(bool threaded READ threaded WRITE setThreaded NOTIFY threadedChanged)
+    // draw into the scene graph's target instead of an fbo drawn again as a texture
+    // OpenGL only, picked when the item is first drawn, takes the place of threaded
+    // a core shared with others still copies its decode texture
+    Q_PROPERTY(bool direct READ direct WRITE setDirect NOTIFY directChanged)
+    // size of the drawn frame relative to the item, stretched back when shown
+    Q_PROPERTY(double renderScale READ renderScale WRITE setRenderScale NOTIFY renderScaleChanged)
+    // software decoding only, scale frames larger than the screen down to it before upload
+    Q_PROPERTY(bool decodeDownscale READ decodeDownscale WRITE setDecodeDownscale NOTIFY decodeDownscaleChanged)
 
     friend class MpvRender;
+    friend class MpvNode;
 
 public:
     static void on_update(void* ctx);
@@ -48,16 +124,54 @@ public:
         Paused,
     };
     Q_ENUM(Status)
+    // same order as Common.DisplayMode
+    enum DisplayMode
+    {
+        Aspect,
+        Crop,
+        Scale,
+    };
+    Q_ENUM(DisplayMode)
     Status  status() const;
     QUrl    source() const;
     bool    mute() const;
     QString logfile() const;
     int     volume() const;
+    DisplayMode displayMode() const { return m_display_mode; }
+    bool        shared() const { return m_shared; }
+    bool        stats() const { return m_stats; }
+    int         maxFps() const { return m_max_fps; }
+    QString     transcodeDir() const { return m_transcode_dir; }
+    int         transcodeLimit() const { return m_transcode_limit; }
+    int         startupMs() const { return m_startup_ms; }
+    bool        threaded() const { return m_threaded; }
+    bool        direct() const { return m_direct; }
+    double      renderScale() const { return m_render_scale; }
+    bool        decodeDownscale() const { return m_decode_downscale; }
 
     void setSource(const QUrl& source);
     void setMute(const bool& mute);
     void setLogfile(const QString& logfile);
     void setVolume(const int& volume);
+    void setDisplayMode(DisplayMode);
+    void setShared(bool);
+    void setStats(bool);
+    void setMaxFps(int);
+    void setTranscodeDir(const QString&);
+    void setTranscodeLimit(int);
+    void setThreaded(bool);
+    void setDirect(bool);
+    void setRenderScale(double);
+    void setDecodeDownscale(bool);
+
+    std::shared_ptr<const RenderStats> renderStats() const { return m_render_stats; }
+    std::shared_ptr<RenderStats>       renderStats() { return m_render_stats; }
+    // playback counters of the core, e.g. frame-drop-count, empty while stopped
+    // mirrored from observed properties, no call into the core
+    QVariantMap playbackCounters() const;
+    // estimated-vf-fps and demuxer-cache-state change with every frame, so they are observed
+    // and in playbackCounters() only while at least one reader wants them
+    void        watchDetail(bool on);
 
 public slots:
     void play();
@@ -67,6 +181,9 @@ public slots:
     bool     command(const QVariant& params);
     bool     setProperty(const QString& name, const QVariant& value);
     QVariant getProperty(const QString& name, bool* ok = nullptr) const;
+    // don't wait for the mpv core, return reply id or -1, result comes with asyncFinished
+    int      commandAsync(const QVariant& params);
+    int      setPropertyAsync(const QString& name, const QVariant& value);
     void     initCallback();
     void     checkAndEmitFirstFrame();
 
@@ -75,16 +192,148 @@ signals:
     void statusChanged();
     void sourceChanged();
     void firstFrame();
+    void muteChanged();
+    void logfileChanged();
+    void volumeChanged();
+    void displayModeChanged();
+    void sharedChanged();
+    void statsChanged();
+    void maxFpsChanged();
+    void transcodeChanged();
+    void threadedChanged();
+    void directChanged();
+    void renderScaleChanged();
+    void decodeDownscaleChanged();
+    // no mpv core could be created, nothing will play
+    void coreFailed();
+    // error is empty on success
+    void asyncFinished(int id, const QVariant& result, const QString& error);
+
+private slots:
+    // drain mpv event queue, gui thread
+    void handleEvents();
+    // new frame from mpv, paced by the shared FrameClock and maxFps
+    void requestUpdate();
+    // after the first frame, queue a transcode if decoding is too heavy
+    void checkTranscode();
+    // vf for decodeDownscale, again after each first frame
+    void applyDecodeScale();
+    void syncStats();
+    // another item joined or left our core, mpv scales for a sole user
+    void refreshSharing();
+
+protected:
+    void     itemChange(ItemChange, const ItemChangeData&) override;
+    QSGNode* updatePaintNode(QSGNode*, UpdatePaintNodeData*) override;
 
 private:
+    // mpv thread, only schedules handleEvents
+    static void on_mpv_wakeup(void* ctx);
+    void        observeProperties();
+    void        handlePropertyChange(const mpv_event_property*, uint64_t id);
+    void        observeDetail();
+    void        handleReply(const mpv_event*);
+    void        updateStatus();
+    void        applyDisplayMode();
+    // native format, no QVariant for properties set on every play/pause
+    template <typename T>
+    int setTypedAsync(const char* name, T value);
+    // pixel size of this item and refresh rate of its screen
+    Transcode::Target screenTarget() const;
+    // surface for the render thread's context, only the gui thread can create it
+    void ensureSurface();
+
+    // own core from MpvPool, gui thread
+    void attachHandle(std::shared_ptr<MpvHandle>);
+    // shared mode, return true if nothing is left to load here: the core already plays source,
+    // or it is loaded once a core of its own arrives
+    bool attachCore(const QUrl& source);
+    void switchHandle(std::shared_ptr<MpvCore>, std::shared_ptr<MpvHandle>);
+    // a core of its own from MpvPool without blocking, then source is loaded on it
+    // empty source stays stopped
+    void leaveShared(const QUrl& source);
+    void leaveCore();
+
     bool   inited = false;
     QUrl   m_source;
     Status m_status = Stopped;
 
+    // state mirrored from observed properties, read without touching the mpv core
+    bool    m_idle { true };
+    bool    m_paused { false };
+    bool    m_mute { false };
+    int     m_volume { 0 };
+    QString m_logfile;
+    QSize   m_video_size;
+    // decoded stream, transcode and decode downscale decide from it
+    struct Stream {
+        bool    hwdec { false };
+        QSize   size;
+        double  fps { 0 };
+        QString codec;
+    } m_stream;
+    // set by handlePropertyChange, handleEvents acts on it once per batch
+    bool    m_stream_changed { false };
+    // waiting on MpvPool for a core of its own, then this is loaded
+    bool    m_switching { false };
+    QUrl    m_switch_source;
+    struct Counters {
+        qint64      dropped { 0 };
+        qint64      decoder_dropped { 0 };
+        qint64      delayed { 0 };
+        double      vf_fps { 0 };
+        QVariantMap cache;
+    } m_counters;
+    int     m_detail_readers { 0 };
+
+    DisplayMode m_display_mode { Aspect };
+    bool        m_shared { false };
+    bool        m_stats { false };
+    // overlay toggled on through our own handle, without a core to count on
+    bool        m_stats_direct { false };
+    // last play()/pause() request, the shared core pauses only when no user wants play
+    bool        m_want_play { true };
+
+    int           m_max_fps { 0 };
+    QString       m_transcode_dir;
+    int           m_transcode_limit { 2048 };
+    // playing a cached copy instead of source
+    bool          m_transcoded { false };
+
+    bool                               m_threaded { true };
+    std::shared_ptr<QOffscreenSurface> m_surface;
+    bool                               m_direct { false };
+    double                             m_render_scale { 1.0 };
+    bool                               m_decode_downscale { false };
+    QString                            m_vf;
+    // render thread, the current node is ours instead of the fbo's
+    bool                               m_paint_node { false };
+    bool                               m_paint_direct { false };
+
+    // set before the core was ready, id 0 for setProperty, else the reply id an async call
+    // already returned
+    struct Pending {
+        int      id;
+        bool     command;
+        QString  name;
+        QVariant value;
+    };
+    QVector<Pending>                  m_pending;
+    QElapsedTimer                     m_startup;
+    int                               m_core_ms { -1 };
+    int                               m_startup_ms { -1 };
+
+    std::atomic<bool> m_events_pending { false };
+    int               m_next_reply { 1 };
+    int               m_load_reply { 0 };
+
 private:
     mpv_handle*                m_mpv { nullptr };
+    // declared before handle, client handle must go first
+    std::shared_ptr<MpvCore>   m_core { nullptr };
     std::shared_ptr<MpvHandle> m_shared_mpv { nullptr };
     bool                       m_first_frame { true };
+    std::shared_ptr<RenderStats> m_render_stats { std::make_shared<RenderStats>() };
 };
 } // namespace mpv
 
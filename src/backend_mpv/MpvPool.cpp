@@ -0,0 +1,139 @@
+#include "MpvPool.hpp"
+#include "MpvBackend.hpp"
+#include "Trace.hpp"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QPointer>
+#include <QtCore/QThreadPool>
+
+#include <mutex>
+#include <vector>
+
+using namespace mpv;
+
+namespace
+{
+// an idle core is a few threads and a few MiB
+constexpr size_t Spare { 1 };
+// creating and terminating cores blocks, kept off the pool other work shares
+constexpr int    Threads { 2 };
+
+struct Pool {
+    std::mutex                              lock;
+    std::vector<std::shared_ptr<MpvHandle>> spares;
+    size_t                                  creating { 0 };
+    bool                                    hooked { false };
+    QThreadPool                             threads;
+};
+
+Pool& Shared() {
+    // spares are dropped before QCoreApplication goes, not at static destruction
+    static Pool* pool = [] {
+        auto* p = new Pool;
+        p->threads.setMaxThreadCount(Threads);
+        return p;
+    }();
+    return *pool;
+}
+
+void Clear() {
+    auto& pool = Shared();
+    // a refill may still be creating one
+    pool.threads.waitForDone();
+    std::vector<std::shared_ptr<MpvHandle>> spares;
+    {
+        std::lock_guard lock(pool.lock);
+        spares.swap(pool.spares);
+    }
+}
+
+std::shared_ptr<MpvHandle> PopSpare() {
+    auto&           pool = Shared();
+    std::lock_guard lock(pool.lock);
+    if (! pool.hooked) {
+        pool.hooked = true;
+        qAddPostRoutine(Clear);
+    }
+    if (pool.spares.empty()) return nullptr;
+    auto handle = pool.spares.back();
+    pool.spares.pop_back();
+    return handle;
+}
+} // namespace
+
+std::shared_ptr<MpvHandle> MpvPool::Create() {
+    Trace::Scope trace("mpv", "createCore");
+    auto         shared = std::make_shared<MpvHandle>(mpv_create());
+    mpv_handle*  mpv    = shared->handle;
+
+    if (! mpv) {
+        qCWarning(wekdeMpv) << "could not create mpv context";
+        return nullptr;
+    }
+    mpv_set_option_string(mpv, "terminal", "no");
+    mpv_set_option_string(mpv, "msg-level", "all=info");
+    if (mpv_initialize(mpv) < 0) {
+        qCWarning(wekdeMpv) << "could not initialize mpv context";
+        return nullptr;
+    }
+
+    mpv_set_option_string(mpv, "config", "no");
+    mpv_set_option_string(mpv, "hwdec", "auto");
+    mpv_set_option_string(mpv, "vo", "libmpv");
+    mpv_set_option_string(mpv, "loop", "inf");
+    return shared;
+}
+
+void MpvPool::Acquire(QObject* context, Ready ready) {
+    if (auto handle = PopSpare()) {
+        Refill();
+        ready(handle);
+        return;
+    }
+    QPointer<QObject> target(context);
+    Shared().threads.start([target, ready]() {
+        auto handle = Create();
+        // QPointer is only read on the gui thread
+        QMetaObject::invokeMethod(
+            qApp,
+            [target, ready, handle]() {
+                if (target)
+                    ready(handle);
+                else if (handle)
+                    Release(handle);
+            },
+            Qt::QueuedConnection);
+    });
+    Refill();
+}
+
+void MpvPool::Refill() {
+    auto& pool = Shared();
+    {
+        std::lock_guard lock(pool.lock);
+        if (pool.spares.size() + pool.creating >= Spare) return;
+        pool.creating++;
+    }
+    pool.threads.start([]() {
+        auto  handle = Create();
+        auto& pool   = Shared();
+        std::lock_guard lock(pool.lock);
+        pool.creating--;
+        if (handle) pool.spares.push_back(handle);
+    });
+}
+
+void MpvPool::Release(std::shared_ptr<MpvHandle> handle) {
+    auto& pool = Shared();
+    {
+        std::lock_guard lock(pool.lock);
+        if (pool.spares.size() < Spare) {
+            pool.spares.push_back(handle);
+            return;
+        }
+    }
+    // terminate waits for the core threads, not on the gui thread
+    pool.threads.start([handle = std::move(handle)]() mutable {
+        handle.reset();
+    });
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <functional>
+#include <memory>
+
+class QObject;
+
+namespace mpv
+{
+
+struct MpvHandle;
+
+// mpv cores created and initialized off the gui thread
+// one spare is kept ready after the first use, so a backend reload or another screen
+// gets its core without waiting for mpv_initialize
+class MpvPool {
+public:
+    using Ready = std::function<void(std::shared_ptr<MpvHandle>)>;
+
+    // ready runs on the thread of context, right away when a spare is waiting
+    // dropped if context is gone by then, the core goes back to the pool
+    // ready gets nullptr if no core could be created
+    static void Acquire(QObject* context, Ready ready);
+    // blocks in mpv_initialize, safe on any thread, nullptr on failure
+    static std::shared_ptr<MpvHandle> Create();
+
+private:
+    static void Refill();
+    static void Release(std::shared_ptr<MpvHandle>);
+};
+} // namespace mpv
@@ -0,0 +1,253 @@
+#include "MpvRenderThread.hpp"
+#include "MpvBackend.hpp"
+#include "Trace.hpp"
+
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLExtraFunctions>
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+#include <QtOpenGL/QOpenGLFramebufferObject>
+#else
+#include <QtGui/QOpenGLFramebufferObject>
+#endif
+
+#include <chrono>
+
+using namespace mpv;
+
+namespace
+{
+// ring textures grow in steps, a resize within a step keeps them
+constexpr int SizeStep { 128 };
+
+int RoundUp(int v) { return std::max(SizeStep, (v + SizeStep - 1) / SizeStep * SizeStep); }
+
+qint64 Bytes(const QSize& s) { return (qint64)s.width() * s.height() * 4; }
+
+// reuse unless too small or more than twice the area needed
+bool Fits(const QOpenGLFramebufferObject* fbo, const QSize& size) {
+    if (! fbo) return false;
+    const QSize cap = fbo->size();
+    return cap.width() >= size.width() && cap.height() >= size.height() &&
+           Bytes(cap) <= 2 * Bytes(QSize(RoundUp(size.width()), RoundUp(size.height())));
+}
+} // namespace
+
+MpvRenderThread::MpvRenderThread(Create create, QOpenGLContext* share,
+                                 std::shared_ptr<QOffscreenSurface> surface,
+                                 std::shared_ptr<RenderStats>       stats)
+    : m_create(std::move(create)), m_share(share), m_surface(surface), m_stats(stats) {
+    setObjectName("mpv-render");
+}
+
+MpvRenderThread::~MpvRenderThread() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_quit = true;
+    }
+    m_cond.notify_all();
+    wait();
+}
+
+bool MpvRenderThread::launch() {
+    if (! m_share || ! m_surface || ! m_surface->isValid()) return false;
+    m_context = std::make_unique<QOpenGLContext>();
+    m_context->setFormat(m_share->format());
+    m_context->setShareContext(m_share);
+    if (! m_context->create() || ! QOpenGLContext::areSharing(m_context.get(), m_share)) {
+        qCWarning(wekdeMpv) << "can't create shared gl context, render in the scene graph";
+        m_context.reset();
+        return false;
+    }
+    m_context->moveToThread(this);
+    start(QThread::HighPriority);
+
+    std::unique_lock lock(m_start_mutex);
+    m_start_cond.wait(lock, [this]() {
+        return m_started != 0;
+    });
+    if (m_started < 0) wait();
+    return m_started > 0;
+}
+
+void MpvRenderThread::setTarget(const QSize& v) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (v == m_target) return;
+        m_target = v;
+        // redraw at the new size even if the video is paused
+        m_wake = true;
+    }
+    m_cond.notify_all();
+}
+
+void MpvRenderThread::setMaxFps(int v) {
+    std::lock_guard lock(m_mutex);
+    m_max_fps = v;
+}
+
+void MpvRenderThread::setOnFrame(std::function<void()> v) {
+    std::lock_guard lock(m_mutex);
+    m_on_frame = std::move(v);
+}
+
+qint64 MpvRenderThread::textureBytes() const { return m_texture_bytes.load(); }
+
+void MpvRenderThread::OnUpdate(void* ctx) {
+    auto* self = static_cast<MpvRenderThread*>(ctx);
+    {
+        std::lock_guard lock(self->m_mutex);
+        self->m_wake = true;
+    }
+    self->m_cond.notify_all();
+}
+
+void MpvRenderThread::run() {
+    auto signal_start = [this](int v) {
+        std::lock_guard lock(m_start_mutex);
+        m_started = v;
+        m_start_cond.notify_all();
+    };
+    if (! m_context->makeCurrent(m_surface.get())) {
+        qCWarning(wekdeMpv) << "can't make shared gl context current";
+        m_context.reset();
+        signal_start(-1);
+        return;
+    }
+    m_mpv_context = m_create();
+    if (! m_mpv_context) {
+        m_context->doneCurrent();
+        m_context.reset();
+        signal_start(-1);
+        return;
+    }
+    mpv_render_context_set_update_callback(m_mpv_context, &MpvRenderThread::OnUpdate, this);
+    signal_start(1);
+
+    using clock = std::chrono::steady_clock;
+    clock::time_point last;
+    QSize             last_size;
+    while (true) {
+        QSize                 target;
+        std::function<void()> on_frame;
+        {
+            std::unique_lock lock(m_mutex);
+            m_cond.wait(lock, [this]() {
+                return m_wake || m_quit;
+            });
+            if (m_quit) break;
+            m_wake = false;
+            // mpv drops what is not drawn, take the latest frame when the cap allows
+            if (m_max_fps > 0 && last.time_since_epoch().count()) {
+                const auto due = last + std::chrono::microseconds(1'000'000 / m_max_fps);
+                m_cond.wait_until(lock, due, [this]() {
+                    return m_quit;
+                });
+                if (m_quit) break;
+            }
+            target   = m_target;
+            on_frame = m_on_frame;
+        }
+
+        m_stats->redraws.fetch_add(1, std::memory_order_relaxed);
+        const uint64_t flags = mpv_render_context_update(m_mpv_context);
+        if (! (flags & MPV_RENDER_UPDATE_FRAME) && target == last_size) continue;
+        if (target.isEmpty()) continue;
+
+        Slot* slot;
+        {
+            std::lock_guard lock(m_ring_mutex);
+            slot = &m_slots[m_back];
+        }
+        const auto start = clock::now();
+        renderSlot(*slot, target);
+        m_stats->record(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+        last      = start;
+        last_size = target;
+
+        {
+            std::lock_guard lock(m_ring_mutex);
+            std::swap(m_back, m_middle);
+            m_fresh = true;
+        }
+        if (on_frame) on_frame();
+    }
+
+    auto* gl = m_context->extraFunctions();
+    mpv_render_context_free(m_mpv_context);
+    m_mpv_context = nullptr;
+    {
+        std::lock_guard lock(m_ring_mutex);
+        for (auto& s : m_slots) {
+            if (s.fence) gl->glDeleteSync(s.fence);
+            if (s.read) gl->glDeleteSync(s.read);
+            s = Slot {};
+        }
+    }
+    m_context->doneCurrent();
+    m_context.reset();
+}
+
+void MpvRenderThread::renderSlot(Slot& slot, const QSize& size) {
+    Trace::Scope trace("mpv", "renderThread");
+    auto*        gl = m_context->extraFunctions();
+    GLsync       read { nullptr };
+    {
+        std::lock_guard lock(m_ring_mutex);
+        std::swap(read, slot.read);
+    }
+    // the scene graph may still draw from this texture
+    if (read) {
+        gl->glWaitSync(read, 0, GL_TIMEOUT_IGNORED);
+        gl->glDeleteSync(read);
+    }
+    if (! Fits(slot.fbo.get(), size)) {
+        slot.fbo = std::make_unique<QOpenGLFramebufferObject>(
+            QSize(RoundUp(size.width()), RoundUp(size.height())));
+        qint64 bytes { 0 };
+        for (const auto& s : m_slots)
+            if (s.fbo) bytes += Bytes(s.fbo->size());
+        m_texture_bytes = bytes;
+    }
+
+    // mpv draws into the first size rows and columns of the texture
+    mpv_opengl_fbo   mpfbo { .fbo             = static_cast<int>(slot.fbo->handle()),
+                             .w               = size.width(),
+                             .h               = size.height(),
+                             .internal_format = 0 };
+    int              flip_y { 0 };
+    mpv_render_param params[] = { { MPV_RENDER_PARAM_OPENGL_FBO, &mpfbo },
+                                  { MPV_RENDER_PARAM_FLIP_Y, &flip_y },
+                                  { MPV_RENDER_PARAM_INVALID, nullptr } };
+    mpv_render_context_render(m_mpv_context, params);
+
+    std::lock_guard lock(m_ring_mutex);
+    if (slot.fence) gl->glDeleteSync(slot.fence);
+    slot.fence = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size  = size;
+    // fence must reach the gpu before the scene graph waits on it
+    gl->glFlush();
+}
+
+MpvRenderThread::Frame MpvRenderThread::acquire() {
+    auto*           gl = QOpenGLContext::currentContext()->extraFunctions();
+    std::lock_guard lock(m_ring_mutex);
+    if (m_fresh) {
+        // every frame drawn with the old front was issued before this sync
+        Slot& old = m_slots[m_front];
+        if (old.fbo) {
+            if (old.read) gl->glDeleteSync(old.read);
+            old.read = gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            // fence must reach the gpu before the writer waits on it
+            gl->glFlush();
+        }
+        std::swap(m_front, m_middle);
+        m_fresh = false;
+    }
+    const Slot& slot = m_slots[m_front];
+    if (! slot.fbo) return {};
+    // front is ours until the next acquire, the writer never deletes its fence meanwhile
+    if (slot.fence) gl->glWaitSync(slot.fence, 0, GL_TIMEOUT_IGNORED);
+    return { slot.fbo->texture(), slot.size, slot.fbo->size() };
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <mpv/client.h>
+#include <mpv/render_gl.h>
+
+#include <QtCore/QSize>
+#include <QtCore/QThread>
+#include <QtGui/qopengl.h>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+
+namespace mpv
+{
+
+struct RenderStats;
+
+// mpv draws on a thread of its own into a ring of three textures, on a context shared with
+// the scene graph; the scene graph draws the newest finished one as it is, so a slow mpv frame
+// (heavy scaler, hwdec upload) no longer holds up the desktop frame
+class MpvRenderThread : public QThread {
+public:
+    using Create = std::function<mpv_render_context*()>;
+
+    struct Frame {
+        GLuint texture { 0 };
+        // mpv drew the first size rows and columns
+        QSize  size;
+        QSize  texture_size;
+    };
+
+    // share is the scene graph context, surface must be created on the gui thread
+    MpvRenderThread(Create, QOpenGLContext* share, std::shared_ptr<QOffscreenSurface> surface,
+                    std::shared_ptr<RenderStats>);
+    // stops and frees the mpv render context
+    ~MpvRenderThread();
+
+    // false if the shared context or the mpv render context can't be made, nothing is running
+    bool launch();
+
+    // pixel size to render at, any thread
+    void setTarget(const QSize&);
+    // 0 renders every frame mpv offers
+    void setMaxFps(int);
+    // called after a frame is published, on this thread
+    void setOnFrame(std::function<void()>);
+
+    // scene graph thread in sync, the newest frame, texture 0 if there is none yet
+    // it stays ours until the next call, the scene graph's draws with the last one are fenced
+    // before the writer may reuse it
+    Frame acquire();
+    // ring textures, for RenderStats::texture_bytes
+    qint64 textureBytes() const;
+
+protected:
+    void run() override;
+
+private:
+    struct Slot {
+        std::unique_ptr<QOpenGLFramebufferObject> fbo;
+        QSize                                     size;               // rendered part of fbo
+        GLsync                                    fence { nullptr };  // mpv done drawing
+        GLsync                                    read { nullptr };   // scene graph done drawing
+    };
+
+    static void OnUpdate(void* ctx);
+    void        renderSlot(Slot&, const QSize&);
+
+    Create                             m_create;
+    QOpenGLContext*                    m_share { nullptr };
+    std::shared_ptr<QOffscreenSurface> m_surface;
+    std::shared_ptr<RenderStats>       m_stats;
+    std::unique_ptr<QOpenGLContext>    m_context;
+    mpv_render_context*                m_mpv_context { nullptr };
+
+    // triple buffer: the writer owns back, the reader owns front, middle is the newest frame
+    mutable std::mutex  m_ring_mutex;
+    std::array<Slot, 3> m_slots;
+    int                 m_front { 0 };
+    int                 m_middle { 1 };
+    int                 m_back { 2 };
+    bool                m_fresh { false };
+    std::atomic<qint64> m_texture_bytes { 0 };
+
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    bool                    m_wake { false };
+    bool                    m_quit { false };
+    QSize                   m_target;
+    int                     m_max_fps { 0 };
+    std::function<void()>   m_on_frame;
+
+    // launch waits for the thread to set up
+    std::mutex              m_start_mutex;
+    std::condition_variable m_start_cond;
+    int                     m_started { 0 }; // 1 ok, -1 failed
+};
+} // namespace mpv
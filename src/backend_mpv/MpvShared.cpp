@@ -0,0 +1,114 @@
+#include "MpvShared.hpp"
+#include "MpvBackend.hpp"
+
+#include <QtCore/QMetaObject>
+
+using namespace mpv;
+
+namespace
+{
+std::mutex                             RegistryMutex;
+QHash<QString, std::weak_ptr<MpvCore>> Registry;
+} // namespace
+
+MpvCore::MpvCore(std::shared_ptr<MpvHandle> primary): m_primary(primary) {}
+
+MpvCore::~MpvCore() {
+    std::lock_guard lock(RegistryMutex);
+    auto            it = Registry.find(m_key);
+    if (it != Registry.end() && it->expired()) Registry.erase(it);
+}
+
+std::shared_ptr<MpvCore> MpvCore::Find(const QString& key) {
+    std::lock_guard lock(RegistryMutex);
+    auto            it = Registry.constFind(key);
+    return it == Registry.cend() ? nullptr : it->lock();
+}
+
+void MpvCore::setKey(const QString& key) {
+    std::lock_guard lock(RegistryMutex);
+    auto            it = Registry.find(m_key);
+    if (it != Registry.end() && it->lock().get() == this) Registry.erase(it);
+    m_key = key;
+    // empty key only unregisters, e.g. after stop
+    if (! key.isEmpty()) Registry.insert(key, weak_from_this());
+}
+
+QString MpvCore::key() const {
+    std::lock_guard lock(RegistryMutex);
+    return m_key;
+}
+
+std::shared_ptr<MpvHandle> MpvCore::createClient() {
+    mpv_handle* h = mpv_create_client(m_primary->handle, nullptr);
+    if (! h) return nullptr;
+    return std::make_shared<MpvHandle>(h, true);
+}
+
+void MpvCore::subscribe(QObject* item) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_items.insert(item);
+    }
+    post("refreshSharing", nullptr);
+}
+
+void MpvCore::unsubscribe(QObject* item) {
+    {
+        std::lock_guard lock(m_mutex);
+        m_items.remove(item);
+        m_playing.remove(item);
+    }
+    setStats(item, false);
+    post("refreshSharing", nullptr);
+}
+
+int MpvCore::users() const {
+    std::lock_guard lock(m_mutex);
+    return m_items.size();
+}
+
+bool MpvCore::setPlaying(const void* who, bool playing) {
+    std::lock_guard lock(m_mutex);
+    if (playing)
+        m_playing.insert(who);
+    else
+        m_playing.remove(who);
+    return ! m_playing.isEmpty();
+}
+
+void MpvCore::setStats(const void* who, bool on) {
+    bool flip { false };
+    {
+        std::lock_guard lock(m_mutex);
+        const bool was = ! m_stats.isEmpty();
+        if (on)
+            m_stats.insert(who);
+        else
+            m_stats.remove(who);
+        flip = was != ! m_stats.isEmpty();
+    }
+    if (! flip) return;
+    // stats.lua only has a toggle, it is sent on the first join and the last leave only
+    const char* args[] { "script-binding", "stats/display-stats-toggle", nullptr };
+    mpv_command_async(m_primary->handle, 0, args);
+}
+
+QSize MpvCore::maxTarget() const {
+    QSize s;
+    for (auto& t : m_frame.targets) s = s.expandedTo(t);
+    return s;
+}
+
+void MpvCore::notify(const QObject* except) {
+    // followers of one core redraw together on the clock
+    post("requestUpdate", except);
+}
+
+void MpvCore::post(const char* method, const QObject* except) {
+    std::lock_guard lock(m_mutex);
+    for (auto* item : m_items) {
+        if (item == except) continue;
+        QMetaObject::invokeMethod(item, method, Qt::QueuedConnection);
+    }
+}
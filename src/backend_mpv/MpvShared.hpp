@@ -0,0 +1,95 @@
+#pragma once
+
+#include <mpv/client.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtGui/qopengl.h>
+#include <array>
+#include <memory>
+#include <mutex>
+
+class QObject;
+class QOpenGLContext;
+
+namespace mpv
+{
+
+struct MpvHandle;
+
+// one mpv core shared by every MpvObject showing the same source
+// the first renderer owns the mpv_render_context; alone it draws straight to its own target,
+// once others join it draws the decoded frame into a texture they copy from their own
+// (shared) gl context
+class MpvCore : public std::enable_shared_from_this<MpvCore> {
+public:
+    explicit MpvCore(std::shared_ptr<MpvHandle> primary);
+    ~MpvCore();
+
+    // process-wide registry, keyed by source url
+    static std::shared_ptr<MpvCore> Find(const QString& key);
+    // must be owned by a shared_ptr
+    void                            setKey(const QString& key);
+    QString                         key() const;
+
+    std::shared_ptr<MpvHandle> primary() const { return m_primary; }
+    // own event queue and observers on the same core
+    std::shared_ptr<MpvHandle> createClient();
+
+    // items to update() when a frame or the leader changes, gui thread
+    // every item is told through refreshSharing() when one joins or leaves
+    void subscribe(QObject* item);
+    void unsubscribe(QObject* item);
+    int  users() const;
+
+    // paused only when nobody wants to play, return true if core should play
+    bool setPlaying(const void* who, bool playing);
+    // the stats overlay is one per core, shown while any user wants it
+    void setStats(const void* who, bool on);
+
+    // the leader draws into one while the others may still copy from the other
+    struct Buffer {
+        GLuint  texture { 0 };
+        QSize   size;
+        // leader done drawing
+        GLsync  fence { nullptr };
+        // new for every texture the leader allocates, gl may hand out a freed name again
+        quint64 generation { 0 };
+        // last copy of each follower, the leader waits on them before drawing here again
+        QHash<const void*, GLsync> reads;
+    };
+    struct Frame {
+        const void*           leader { nullptr };
+        QOpenGLContext*       context { nullptr };
+        std::array<Buffer, 2> buffers;
+        // newest finished buffer, -1 for none
+        int                   front { -1 };
+        quint64               serial { 0 };
+        quint64               generation { 0 };
+        // fbo size of every renderer, decode size covers the largest
+        QHash<const void*, QSize> targets;
+    };
+    // lock mutex() around any frame() access
+    std::mutex& mutex() { return m_mutex; }
+    Frame&      frame() { return m_frame; }
+    QSize       maxTarget() const;
+
+    // post update() to all subscribers except one, any thread
+    void notify(const QObject* except = nullptr);
+
+private:
+    void post(const char* method, const QObject* except);
+
+    std::shared_ptr<MpvHandle> m_primary;
+    QString                    m_key;
+
+    mutable std::mutex m_mutex;
+    Frame              m_frame;
+    QSet<QObject*>     m_items;
+    QSet<const void*>  m_playing;
+    QSet<const void*>  m_stats;
+};
+
+} // namespace mpv
@@ -0,0 +1,199 @@
+#include "MpvTranscode.hpp"
+#include <mpv/client.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QLoggingCategory>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+Q_LOGGING_CATEGORY(wekdeTranscode, "wekde.transcode")
+
+using namespace mpv;
+
+namespace
+{
+// codecs that cost a core or more in software at 4k
+constexpr const char* HeavyCodecs[] { "hevc", "vp9", "av1" };
+
+struct Queue {
+    std::atomic<bool> stop { false };
+    QMutex            lock;
+    QSet<QString>     pending;
+    QThreadPool       pool;
+
+    Queue() {
+        pool.setMaxThreadCount(1);
+        pool.setThreadPriority(QThread::LowestPriority);
+    }
+};
+
+// don't hold up exit for a long encode
+void StopQueue();
+
+Queue& Shared() {
+    // stopped before QCoreApplication goes, an encode must not run into static destruction
+    static Queue* queue = [] {
+        qAddPostRoutine(StopQueue);
+        return new Queue;
+    }();
+    return *queue;
+}
+
+void StopQueue() {
+    auto& q = Shared();
+    q.stop  = true;
+    q.pool.clear();
+    q.pool.waitForDone();
+}
+
+int Even(int v) { return std::max(2, v & ~1); }
+} // namespace
+
+QString Transcode::Path(const QString& dir, const QString& source, const Target& t) {
+    const QFileInfo info(source);
+    if (! info.isFile()) return {};
+    // a replaced source gets a new copy
+    const QString key = QString("%1|%2|%3|%4x%5@%6")
+                            .arg(source)
+                            .arg(info.size())
+                            .arg(info.lastModified().toMSecsSinceEpoch())
+                            .arg(t.size.width())
+                            .arg(t.size.height())
+                            .arg(t.fps);
+    const auto hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    return dir + "/" + hash.toHex() + ".mp4";
+}
+
+QString Transcode::Lookup(const QString& dir, const QString& source, const Target& t) {
+    if (dir.isEmpty() || t.size.isEmpty()) return {};
+    const QString path = Path(dir, source, t);
+    if (path.isEmpty() || ! QFileInfo::exists(path)) return {};
+    // mtime is the last use for eviction
+    QFile f(path);
+    if (f.open(QIODevice::ReadWrite))
+        f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return path;
+}
+
+Transcode::Target Transcode::Fit(const QSize& video, double fps, const Target& t) {
+    // 0 keeps the source rate
+    const int rate = fps > 0 && t.fps > 0 ? std::min(t.fps, qRound(fps)) : t.fps;
+    Target    out { video, rate };
+    // cover the screen like crop mode would, the display mode still applies on top
+    const QSize cover = video.scaled(t.size, Qt::KeepAspectRatioByExpanding);
+    if (cover.width() < video.width()) out.size = cover;
+    out.size = QSize(Even(out.size.width()), Even(out.size.height()));
+    return out;
+}
+
+bool Transcode::Heavy(const QSize& size, double fps, const QString& codec, const Target& t) {
+    for (const char* c : HeavyCodecs) {
+        if (codec == c) return true;
+    }
+    const qint64 area   = (qint64)size.width() * size.height();
+    const qint64 target = (qint64)t.size.width() * t.size.height();
+    return area > target * 3 / 2 || (t.fps > 0 && fps > t.fps + 1);
+}
+
+void Transcode::Request(const QString& dir, const QString& source, const Target& screen,
+                        const Target& t, qint64 limit) {
+    const QString out = Path(dir, source, screen);
+    if (dir.isEmpty() || out.isEmpty() || QFileInfo::exists(out)) return;
+
+    auto& q = Shared();
+    {
+        QMutexLocker lock(&q.lock);
+        if (q.pending.contains(out)) return;
+        q.pending.insert(out);
+    }
+    qCInfo(wekdeTranscode) << "queued" << source << t.size << t.fps << "fps";
+    q.pool.start([dir, source, t, limit, out]() {
+        auto& q = Shared();
+        QDir().mkpath(dir);
+        const QString part = out + ".part";
+        if (! q.stop && Encode(source, part, t)) {
+            QFile::remove(out);
+            QFile::rename(part, out);
+            qCInfo(wekdeTranscode) << "done" << source << "->" << out;
+            Evict(dir, limit);
+        } else {
+            QFile::remove(part);
+            qCWarning(wekdeTranscode) << "failed or stopped" << source;
+        }
+        QMutexLocker lock(&q.lock);
+        q.pending.remove(out);
+    });
+}
+
+void Transcode::Evict(const QString& dir, qint64 limit) {
+    QDir d(dir);
+    // newest first
+    const auto files = d.entryInfoList({ "*.mp4" }, QDir::Files, QDir::Time);
+    qint64     total { 0 };
+    for (const auto& f : files) {
+        total += f.size();
+        if (total > limit && QFile::remove(f.absoluteFilePath()))
+            qCDebug(wekdeTranscode) << "evicted" << f.fileName();
+    }
+}
+
+bool Transcode::Encode(const QString& source, const QString& out, const Target& t) {
+    mpv_handle* mpv = mpv_create();
+    if (! mpv) return false;
+
+    // fps filter keeps the loop length, so the copy loops as cleanly as the source
+    QString filter = QString("scale=w=%1:h=%2").arg(t.size.width()).arg(t.size.height());
+    if (t.fps > 0) filter += QString(",fps=%1").arg(t.fps);
+    const QByteArray vf = QString("lavfi=[%1]").arg(filter).toUtf8();
+    const QByteArray o  = QFile::encodeName(out);
+    const std::pair<const char*, const char*> options[] {
+        { "config", "no" },
+        { "terminal", "no" },
+        { "msg-level", "all=warn" },
+        { "hwdec", "auto-safe" },
+        { "vd-lavc-threads", "2" },
+        { "loop-file", "no" },
+        { "o", o.constData() },
+        { "of", "mp4" },
+        // cheap to decode in software, hw decoders have it everywhere
+        { "ovc", "libx264" },
+        { "ovcopts", "preset=veryfast,crf=20,threads=2" },
+        { "oac", "aac" },
+        { "vf", vf.constData() },
+    };
+    for (const auto& [k, v] : options) mpv_set_option_string(mpv, k, v);
+
+    bool ok = mpv_initialize(mpv) >= 0;
+    if (ok) {
+        const QByteArray path  = QFile::encodeName(source);
+        const char*      cmd[] { "loadfile", path.constData(), nullptr };
+        ok = mpv_command(mpv, cmd) >= 0;
+    }
+    auto& q = Shared();
+    while (ok) {
+        if (q.stop) {
+            ok = false;
+            break;
+        }
+        mpv_event* ev = mpv_wait_event(mpv, 0.5);
+        if (ev->event_id == MPV_EVENT_END_FILE) {
+            auto* end = static_cast<mpv_event_end_file*>(ev->data);
+            ok        = end->reason == MPV_END_FILE_REASON_EOF;
+            break;
+        }
+        if (ev->event_id == MPV_EVENT_SHUTDOWN) ok = false;
+    }
+    // finishes the muxer
+    mpv_terminate_destroy(mpv);
+    return ok;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <QtCore/QSize>
+#include <QtCore/QString>
+
+namespace mpv
+{
+
+// screen matched h264 copies of heavy videos, encoded in the background by mpv itself
+// one encode at a time at low priority, the cache dir is trimmed to a size limit
+class Transcode {
+public:
+    struct Target {
+        QSize size;
+        int   fps { 0 };
+    };
+
+    // cached copy of source for a screen, empty if there is none yet
+    static QString Lookup(const QString& dir, const QString& source, const Target& screen);
+    // encode source for screen as the encode target, ignored if cached or already queued
+    static void Request(const QString& dir, const QString& source, const Target& screen,
+                        const Target& encode, qint64 limit);
+    // drop least recently used copies until dir fits in limit bytes
+    static void Evict(const QString& dir, qint64 limit);
+
+    // worth it for a video of this size, fps and codec (mpv video-format) on target
+    static bool Heavy(const QSize& size, double fps, const QString& codec, const Target&);
+    // encode target for a video on screen, never upscales, even sizes for the encoder
+    static Target Fit(const QSize& video, double fps, const Target& screen);
+
+private:
+    static QString Path(const QString& dir, const QString& source, const Target& screen);
+    static bool    Encode(const QString& source, const QString& out, const Target&);
+};
+} // namespace mpv
@@ -0,0 +1,210 @@
+#include "Trace.hpp"
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace mpv;
+
+namespace
+{
+// per thread, about 600KiB once a thread records its first event
+constexpr size_t RingSize { 4096 };
+// threads past this many at once record nothing
+constexpr size_t MaxRings { 64 };
+
+struct Event {
+    qint64  ts;
+    qint64  dur;
+    quint64 id;
+    char    ph;
+    char    cat[15];
+    char    name[32];
+    char    arg[88];
+};
+
+// seq is odd while the writer fills ev, dump skips those
+struct Slot {
+    std::atomic<quint64> seq { 0 };
+    Event                ev;
+};
+
+struct Ring {
+    qint64               tid { 0 };
+    QByteArray           thread;
+    std::atomic<quint64> head { 0 };
+    std::array<Slot, RingSize> slots;
+};
+
+// the lock guards the lists and a ring's tid and thread, not the events
+std::mutex                         RingsLock;
+std::vector<std::unique_ptr<Ring>> Rings;
+// rings of exited threads, still dumped until another thread takes one over
+std::vector<Ring*>                 Free;
+
+// gives the ring back when its thread exits, pool and mpv threads come and go
+struct Owner {
+    Ring* ring { nullptr };
+    ~Owner() {
+        if (! ring) return;
+        std::lock_guard lock(RingsLock);
+        Free.push_back(ring);
+    }
+};
+thread_local Owner Local;
+
+bool EnvEnabled() {
+    const QByteArray v = qgetenv("WEKDE_TRACE");
+    return ! v.isEmpty() && v != "0";
+}
+
+// nullptr when MaxRings threads already have one
+Ring* LocalRing() {
+    if (Local.ring) return Local.ring;
+    char name[16] {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+
+    std::lock_guard lock(RingsLock);
+    Ring*           ring { nullptr };
+    if (! Free.empty()) {
+        ring = Free.back();
+        Free.pop_back();
+        // its writer is gone and dump holds the lock, the old events can go
+        ring->head.store(0, std::memory_order_relaxed);
+        for (auto& s : ring->slots) s.seq.store(0, std::memory_order_relaxed);
+    } else if (Rings.size() < MaxRings) {
+        Rings.push_back(std::make_unique<Ring>());
+        ring = Rings.back().get();
+    } else {
+        return nullptr;
+    }
+    ring->tid    = (qint64)syscall(SYS_gettid);
+    ring->thread = name;
+    Local.ring   = ring;
+    return ring;
+}
+
+template <size_t N>
+void Copy(char (&dst)[N], const char* src) {
+    size_t i { 0 };
+    for (; src && i + 1 < N && src[i]; i++) dst[i] = src[i];
+    dst[i] = '\0';
+}
+} // namespace
+
+std::atomic<bool> Trace::s_enabled { EnvEnabled() };
+
+void Trace::SetEnabled(bool v) {
+    s_enabled.store(v, std::memory_order_relaxed);
+    if (v) return;
+    // threads still running keep theirs, they record again once enabled
+    std::lock_guard lock(RingsLock);
+    Rings.erase(std::remove_if(Rings.begin(),
+                               Rings.end(),
+                               [](const std::unique_ptr<Ring>& r) {
+                                   return std::find(Free.begin(), Free.end(), r.get()) !=
+                                          Free.end();
+                               }),
+                Rings.end());
+    Free.clear();
+}
+
+qint64 Trace::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Trace::Instant(const char* cat, const char* name, const char* arg) {
+    if (! Enabled()) return;
+    Record('i', cat, name, arg, NowNs(), 0, 0);
+}
+
+void Trace::Complete(const char* cat, const char* name, qint64 start_ns, qint64 dur_ns,
+                     const char* arg) {
+    if (! Enabled()) return;
+    Record('X', cat, name, arg, start_ns, dur_ns, 0);
+}
+
+void Trace::Begin(const char* cat, const char* name, quint64 id, const char* arg) {
+    if (! Enabled()) return;
+    Record('b', cat, name, arg, NowNs(), 0, id);
+}
+
+void Trace::End(const char* cat, const char* name, quint64 id) {
+    if (! Enabled()) return;
+    Record('e', cat, name, nullptr, NowNs(), 0, id);
+}
+
+void Trace::Record(char ph, const char* cat, const char* name, const char* arg, qint64 ts,
+                   qint64 dur, quint64 id) {
+    Ring* r = LocalRing();
+    if (! r) return;
+    const quint64 idx = r->head.load(std::memory_order_relaxed);
+    Slot&         s   = r->slots[idx % RingSize];
+
+    s.seq.store(idx * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.ev.ts  = ts;
+    s.ev.dur = dur;
+    s.ev.id  = id;
+    s.ev.ph  = ph;
+    Copy(s.ev.cat, cat);
+    Copy(s.ev.name, name);
+    Copy(s.ev.arg, arg);
+    s.seq.store(idx * 2 + 2, std::memory_order_release);
+    r->head.store(idx + 1, std::memory_order_release);
+}
+
+QByteArray Trace::Dump() {
+    const qint64 pid = getpid();
+    QJsonArray   events;
+
+    std::lock_guard lock(RingsLock);
+    for (const auto& r : Rings) {
+        events.append(QJsonObject {
+            { "ph", "M" },
+            { "name", "thread_name" },
+            { "pid", pid },
+            { "tid", r->tid },
+            { "args", QJsonObject { { "name", QString::fromUtf8(r->thread) } } },
+        });
+
+        const quint64 head = r->head.load(std::memory_order_acquire);
+        const quint64 from = head > RingSize ? head - RingSize : 0;
+        for (quint64 i = from; i < head; i++) {
+            const Slot&   s   = r->slots[i % RingSize];
+            const quint64 seq = s.seq.load(std::memory_order_acquire);
+            if (seq != i * 2 + 2) continue;
+            const Event ev = s.ev;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // overwritten while copying
+            if (s.seq.load(std::memory_order_relaxed) != seq) continue;
+
+            QJsonObject o {
+                { "ph", QString(QChar(ev.ph)) },
+                { "cat", QString::fromUtf8(ev.cat) },
+                { "name", QString::fromUtf8(ev.name) },
+                { "pid", pid },
+                { "tid", r->tid },
+                { "ts", ev.ts / 1000.0 },
+            };
+            if (ev.ph == 'X') o["dur"] = ev.dur / 1000.0;
+            if (ev.ph == 'i') o["s"] = "t";
+            if (ev.ph == 'b' || ev.ph == 'e') o["id"] = QString::number(ev.id, 16);
+            if (ev.arg[0]) o["args"] = QJsonObject { { "arg", QString::fromUtf8(ev.arg) } };
+            events.append(o);
+        }
+    }
+    return QJsonDocument(QJsonObject { { "traceEvents", events }, { "displayTimeUnit", "ms" } })
+        .toJson(QJsonDocument::Compact);
+}
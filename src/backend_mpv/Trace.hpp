@@ -0,0 +1,53 @@
+#pragma once
+#include <QtCore/QByteArray>
+#include <QtCore/QtGlobal>
+#include <atomic>
+
+namespace mpv
+{
+
+// startup and frame timeline, exported as chrome trace json (chrome://tracing, ui.perfetto.dev)
+// always built in, records only when enabled by WEKDE_TRACE=1 or SetEnabled
+// every thread writes its own ring without locks, the oldest events are overwritten
+// a thread's ring is reused after it exits, turning tracing off frees those of exited threads
+class Trace {
+public:
+    static bool Enabled() { return s_enabled.load(std::memory_order_relaxed); }
+    static void SetEnabled(bool);
+
+    static qint64 NowNs();
+
+    // strings are copied and cut to fit, no allocation while recording
+    static void Instant(const char* cat, const char* name, const char* arg = nullptr);
+    static void Complete(const char* cat, const char* name, qint64 start_ns, qint64 dur_ns,
+                         const char* arg = nullptr);
+    // async span, may cross threads and overlap others with the same name
+    static void Begin(const char* cat, const char* name, quint64 id, const char* arg = nullptr);
+    static void End(const char* cat, const char* name, quint64 id);
+
+    // events of all threads, safe while others record
+    static QByteArray Dump();
+
+    // complete event for the enclosing scope
+    class Scope {
+    public:
+        Scope(const char* cat, const char* name)
+            : m_cat(cat), m_name(name), m_start(Enabled() ? NowNs() : 0) {}
+        ~Scope() {
+            if (m_start) Complete(m_cat, m_name, m_start, NowNs() - m_start);
+        }
+
+    private:
+        Q_DISABLE_COPY(Scope)
+        const char* m_cat;
+        const char* m_name;
+        qint64      m_start;
+    };
+
+private:
+    static void Record(char ph, const char* cat, const char* name, const char* arg, qint64 ts,
+                       qint64 dur, quint64 id);
+
+    static std::atomic<bool> s_enabled;
+};
+} // namespace mpv
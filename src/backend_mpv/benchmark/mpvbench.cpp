@@ -0,0 +1,207 @@
+// headless render benchmark for MpvObject
+// renders through QQuickRenderControl into an offscreen fbo, no window or gpu needed
+// e.g. LIBGL_ALWAYS_SOFTWARE=1 QT_QPA_PLATFORM=offscreen ./mpvbench --frames 300
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QTimer>
+#include <QtOpenGL/QOpenGLFramebufferObject>
+#include <QtQuick/QQuickGraphicsDevice>
+#include <QtQuick/QQuickRenderControl>
+#include <QtQuick/QQuickRenderTarget>
+#include <QtQuick/QQuickWindow>
+
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "MpvBackend.hpp"
+
+namespace
+{
+constexpr const char* DefaultSource { "av://lavfi:testsrc2=size=1920x1080:rate=60" };
+
+double CpuSeconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec +
+           (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// current and peak resident set in KiB
+std::pair<qint64, qint64> RssKiB() {
+    qint64 current { 0 };
+    if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+        long size { 0 }, resident { 0 };
+        if (std::fscanf(f, "%ld %ld", &size, &resident) == 2)
+            current = resident * (sysconf(_SC_PAGESIZE) / 1024);
+        std::fclose(f);
+    }
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return { current, ru.ru_maxrss };
+}
+
+QJsonObject Summary(std::vector<qint64> ns) {
+    QJsonObject o;
+    o["count"] = (int)ns.size();
+    if (ns.empty()) return o;
+    std::sort(ns.begin(), ns.end());
+    auto at = [&ns](double p) {
+        return ns[std::min(ns.size() - 1, size_t(p * (ns.size() - 1) + 0.5))] / 1e6;
+    };
+    double sum { 0 };
+    for (auto v : ns) sum += v;
+    o["min_ms"]  = ns.front() / 1e6;
+    o["mean_ms"] = sum / ns.size() / 1e6;
+    o["p50_ms"]  = at(0.50);
+    o["p95_ms"]  = at(0.95);
+    o["p99_ms"]  = at(0.99);
+    o["max_ms"]  = ns.back() / 1e6;
+    return o;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::OpenGL);
+    QGuiApplication app(argc, argv);
+    std::setlocale(LC_NUMERIC, "C");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("render MpvObject offscreen and print timings as json");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "frames", "frames to render", "n", "300" },
+        { "size", "render target size", "WxH", "1280x720" },
+        { "timeout", "give up after seconds", "s", "60" },
+        { "hwdec", "mpv hwdec option", "mode", "no" },
+        { "inline", "render in the scene graph instead of on the render thread" },
+        { "direct", "draw into the window's target instead of the item fbo, no render thread" },
+    });
+    parser.addPositionalArgument("source", "video file or url, default a lavfi test pattern");
+    parser.process(app);
+
+    const int   frames  = parser.value("frames").toInt();
+    const auto  wh      = parser.value("size").split('x');
+    const QSize size    = wh.size() == 2 ? QSize(wh[0].toInt(), wh[1].toInt()) : QSize(1280, 720);
+    const int   timeout = parser.value("timeout").toInt() * 1000;
+    const QUrl  source  = parser.positionalArguments().isEmpty()
+                              ? QUrl(DefaultSource)
+                              : QUrl::fromUserInput(parser.positionalArguments().first(),
+                                                   QDir::currentPath(), QUrl::AssumeLocalFile);
+
+    QOpenGLContext context;
+    if (! context.create()) {
+        std::fprintf(stderr, "can't create gl context\n");
+        return 1;
+    }
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    context.makeCurrent(&surface);
+
+    QQuickRenderControl control;
+    QQuickWindow        window(&control);
+    window.setGraphicsDevice(QQuickGraphicsDevice::fromOpenGLContext(&context));
+    window.setGeometry(0, 0, size.width(), size.height());
+    if (! control.initialize()) {
+        std::fprintf(stderr, "can't initialize render control\n");
+        return 1;
+    }
+    QOpenGLFramebufferObject fbo(size, QOpenGLFramebufferObject::CombinedDepthStencil);
+    window.setRenderTarget(QQuickRenderTarget::fromOpenGLTexture(fbo.texture(), size));
+
+    auto* mpv = new mpv::MpvObject(window.contentItem());
+    mpv->setSize(size);
+    mpv->setThreaded(! parser.isSet("inline"));
+    mpv->setDirect(parser.isSet("direct"));
+    mpv->setProperty("hwdec", parser.value("hwdec"));
+    mpv->setMute(true);
+    const auto stats = mpv->renderStats();
+
+    QElapsedTimer clock;
+    qint64        first_frame_ns { -1 };
+    QObject::connect(mpv, &mpv::MpvObject::firstFrame, [&]() {
+        first_frame_ns = clock.nsecsElapsed();
+    });
+
+    bool dirty { true };
+    QObject::connect(&control, &QQuickRenderControl::renderRequested, [&]() {
+        dirty = true;
+    });
+    QObject::connect(&control, &QQuickRenderControl::sceneChanged, [&]() {
+        dirty = true;
+    });
+    // wake the loop even if nothing was queued
+    QTimer wake;
+    wake.start(5);
+
+    std::vector<qint64> render_ns;
+    render_ns.reserve(frames);
+    // whole scene graph frame, includes the copy of the item fbo that direct mode skips
+    std::vector<qint64> frame_ns;
+    frame_ns.reserve(frames);
+    quint64 seen { 0 };
+
+    const double cpu_start = CpuSeconds();
+    clock.start();
+    mpv->setSource(source);
+
+    while ((int)render_ns.size() < frames && clock.elapsed() < timeout) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        if (! dirty) continue;
+        dirty = false;
+
+        const qint64 frame_start = clock.nsecsElapsed();
+        control.polishItems();
+        control.beginFrame();
+        control.sync();
+        control.render();
+        control.endFrame();
+        context.functions()->glFinish();
+
+        const quint64 n = stats->frames;
+        // only frames the renderer drew, after the first one
+        if (n != seen && first_frame_ns >= 0) {
+            render_ns.push_back(stats->last_ns);
+            frame_ns.push_back(clock.nsecsElapsed() - frame_start);
+        }
+        seen = n;
+    }
+    const double wall    = clock.nsecsElapsed() / 1e9;
+    const double cpu     = CpuSeconds() - cpu_start;
+    const auto [rss, peak] = RssKiB();
+
+    QJsonObject out;
+    out["source"]         = source.toString();
+    out["width"]          = size.width();
+    out["height"]         = size.height();
+    out["gl_renderer"]    = QString::fromUtf8(
+        reinterpret_cast<const char*>(context.functions()->glGetString(GL_RENDERER)));
+    out["frames"]         = (int)render_ns.size();
+    out["timed_out"]      = (int)render_ns.size() < frames;
+    out["first_frame_ms"] = first_frame_ns < 0 ? QJsonValue() : QJsonValue(first_frame_ns / 1e6);
+    out["render"]         = Summary(render_ns);
+    out["frame"]          = Summary(frame_ns);
+    out["direct"]         = mpv->direct();
+    out["threaded"]       = mpv->threaded() && ! mpv->direct();
+    out["wall_s"]         = wall;
+    out["cpu_s"]          = cpu;
+    out["cpu_percent"]    = wall > 0 ? 100.0 * cpu / wall : 0.0;
+    out["rss_kib"]        = rss;
+    out["peak_rss_kib"]   = peak;
+    std::printf("%s\n", QJsonDocument(out).toJson(QJsonDocument::Indented).constData());
+
+    delete mpv;
+    control.invalidate();
+    return out["timed_out"].toBool() ? 2 : 0;
+}
@@ -0,0 +1,240 @@
+// allocations per call of the qthelper property paths: the old heap node_builder ("before"),
+// the arena one ("variant") and the typed accessors ("typed")
+// counts malloc on the calling thread, mpv's core thread is not included
+// e.g. ./qthelperbench --calls 10000
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <clocale>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+
+#include "qthelper.hpp"
+
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+
+namespace
+{
+// trivial type in the executable, static tls, safe inside malloc
+thread_local quint64 Allocs { 0 };
+} // namespace
+
+extern "C" void* malloc(size_t size) {
+    Allocs++;
+    return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t n, size_t size) {
+    Allocs++;
+    return __libc_calloc(n, size);
+}
+extern "C" void* realloc(void* p, size_t size) {
+    Allocs++;
+    return __libc_realloc(p, size);
+}
+
+// qthelper as it was before the arena, kept here so both sides are measured in one run
+namespace legacy
+{
+struct node_builder {
+    explicit node_builder(const QVariant& v): node_() { set(&node_, v); }
+    ~node_builder() { free_node(&node_); }
+    mpv_node* node() { return &node_; }
+
+private:
+    Q_DISABLE_COPY(node_builder)
+    mpv_node node_;
+
+    mpv_node_list* create_list(mpv_node* dst, bool is_map, int num) {
+        dst->format = is_map ? MPV_FORMAT_NODE_MAP : MPV_FORMAT_NODE_ARRAY;
+        try {
+            mpv_node_list* list = new mpv_node_list();
+            dst->u.list         = list;
+            list->values        = new mpv_node[num]();
+            if (is_map) list->keys = new char*[num]();
+            return list;
+        } catch (const std::bad_alloc&) {
+            free_node(dst);
+            return nullptr;
+        }
+    }
+    char* dup_qstring(const QString& s) {
+        QByteArray b = s.toUtf8();
+        char*      r = new char[b.size() + 1];
+        std::memcpy(r, b.data(), b.size() + 1);
+        return r;
+    }
+    bool test_type(const QVariant& v, QMetaType::Type t) {
+        return v.typeId() == static_cast<int>(t);
+    }
+    void set(mpv_node* dst, const QVariant& src) {
+        if (test_type(src, QMetaType::QString)) {
+            dst->format   = MPV_FORMAT_STRING;
+            dst->u.string = dup_qstring(src.toString());
+        } else if (test_type(src, QMetaType::Bool)) {
+            dst->format = MPV_FORMAT_FLAG;
+            dst->u.flag = src.toBool() ? 1 : 0;
+        } else if (test_type(src, QMetaType::Int) || test_type(src, QMetaType::LongLong) ||
+                   test_type(src, QMetaType::UInt) || test_type(src, QMetaType::ULongLong)) {
+            dst->format  = MPV_FORMAT_INT64;
+            dst->u.int64 = src.toLongLong();
+        } else if (test_type(src, QMetaType::Double)) {
+            dst->format    = MPV_FORMAT_DOUBLE;
+            dst->u.double_ = src.toDouble();
+        } else if (src.canConvert<QVariantList>()) {
+            QVariantList   qlist = src.toList();
+            mpv_node_list* list  = create_list(dst, false, qlist.size());
+            if (! list) goto fail;
+            list->num = qlist.size();
+            for (int n = 0; n < qlist.size(); n++) set(&list->values[n], qlist[n]);
+        } else if (src.canConvert<QVariantMap>()) {
+            QVariantMap    qmap = src.toMap();
+            mpv_node_list* list = create_list(dst, true, qmap.size());
+            if (! list) goto fail;
+            list->num = qmap.size();
+            for (int n = 0; n < qmap.size(); n++) {
+                list->keys[n] = dup_qstring(qmap.keys()[n]);
+                set(&list->values[n], qmap.values()[n]);
+            }
+        } else {
+            goto fail;
+        }
+        return;
+    fail:
+        dst->format = MPV_FORMAT_NONE;
+    }
+    void free_node(mpv_node* dst) {
+        switch (dst->format) {
+        case MPV_FORMAT_STRING: delete[] dst->u.string; break;
+        case MPV_FORMAT_NODE_ARRAY:
+        case MPV_FORMAT_NODE_MAP: {
+            mpv_node_list* list = dst->u.list;
+            if (list) {
+                for (int n = 0; n < list->num; n++) {
+                    if (list->keys) delete[] list->keys[n];
+                    if (list->values) free_node(&list->values[n]);
+                }
+                delete[] list->keys;
+                delete[] list->values;
+            }
+            delete list;
+            break;
+        }
+        default:;
+        }
+        dst->format = MPV_FORMAT_NONE;
+    }
+};
+
+QVariant get_property(mpv_handle* ctx, const QString& name) {
+    mpv_node node;
+    int      err = mpv_get_property(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, &node);
+    if (err < 0) return QVariant::fromValue(mpv::qt::ErrorReturn(err));
+    mpv::qt::node_autofree f(&node);
+    return mpv::qt::node_to_variant(&node);
+}
+
+int set_property(mpv_handle* ctx, const QString& name, const QVariant& v) {
+    node_builder node(v);
+    return mpv_set_property(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, node.node());
+}
+} // namespace legacy
+
+namespace
+{
+QJsonObject Measure(int calls, const std::function<void()>& fn) {
+    // first call may set up caches
+    fn();
+    QElapsedTimer clock;
+    const quint64 start = Allocs;
+    clock.start();
+    for (int i = 0; i < calls; i++) fn();
+    const qint64  ns     = clock.nsecsElapsed();
+    const quint64 allocs = Allocs - start;
+
+    QJsonObject o;
+    o["allocs_per_call"] = (double)allocs / calls;
+    o["ns_per_call"]     = (double)ns / calls;
+    return o;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+    std::setlocale(LC_NUMERIC, "C");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("count allocations of mpv property access and print json");
+    parser.addHelpOption();
+    parser.addOptions({
+        { "calls", "calls per case", "n", "10000" },
+    });
+    parser.process(app);
+    const int calls = std::max(1, parser.value("calls").toInt());
+
+    mpv_handle* mpv = mpv_create();
+    if (! mpv) {
+        std::fprintf(stderr, "can't create mpv\n");
+        return 1;
+    }
+    mpv_set_option_string(mpv, "vo", "null");
+    mpv_set_option_string(mpv, "ao", "null");
+    mpv_set_option_string(mpv, "terminal", "no");
+    mpv_set_option_string(mpv, "config", "no");
+    if (mpv_initialize(mpv) < 0) {
+        std::fprintf(stderr, "can't initialize mpv\n");
+        return 1;
+    }
+
+    namespace qt = mpv::qt;
+    QJsonObject out;
+    out["calls"] = calls;
+
+    QJsonObject get_flag;
+    get_flag["before"]  = Measure(calls, [mpv]() { legacy::get_property(mpv, "pause"); });
+    get_flag["variant"] = Measure(calls, [mpv]() { qt::get_property(mpv, "pause"); });
+    get_flag["typed"]   = Measure(calls, [mpv]() {
+        bool v { false };
+        qt::get(mpv, "pause", &v);
+    });
+    out["get_pause"] = get_flag;
+
+    QJsonObject get_int;
+    get_int["before"]  = Measure(calls, [mpv]() { legacy::get_property(mpv, "playlist-count"); });
+    get_int["variant"] = Measure(calls, [mpv]() { qt::get_property(mpv, "playlist-count"); });
+    get_int["typed"]   = Measure(calls, [mpv]() {
+        int64_t v { 0 };
+        qt::get(mpv, "playlist-count", &v);
+    });
+    out["get_playlist_count"] = get_int;
+
+    QJsonObject set_double;
+    set_double["before"]  = Measure(calls, [mpv]() { legacy::set_property(mpv, "volume", 50.0); });
+    set_double["variant"] = Measure(calls, [mpv]() { qt::set_property(mpv, "volume", 50.0); });
+    set_double["typed"]   = Measure(calls, [mpv]() { qt::set(mpv, "volume", 50.0); });
+    out["set_volume"] = set_double;
+
+    // conversion only, the arena keeps small commands off the heap
+    const QVariant loadfile = QVariantList { "loadfile", "/tmp/wallpaper.mp4", "replace" };
+    QJsonObject    build;
+    build["before"]  = Measure(calls, [&loadfile]() {
+        legacy::node_builder node(loadfile);
+        (void)node.node();
+    });
+    build["variant"] = Measure(calls, [&loadfile]() {
+        qt::node_builder node(loadfile);
+        (void)node.node();
+    });
+    out["build_loadfile"] = build;
+
+    mpv_terminate_destroy(mpv);
+    std::printf("%s\n", QJsonDocument(out).toJson(QJsonDocument::Indented).constData());
+    return 0;
+}
@@ -4,9 +4,17 @@
 #include <mpv/client.h>
 
 #include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <vector>
+#include <algorithm>
 
 #include <QVariant>
 #include <QString>
+#include <QStringEncoder>
 #include <QList>
 #include <QHash>
 #include <QSharedPointer>
@@ -75,53 +83,99 @@ static inline QVariant node_to_variant(const mpv_node *node)
     }
 }
 
+/**
+ * Bump allocator that owns everything a node_builder creates, released in one
+ * go. A property value or a loadfile command fits in the inline buffer, so
+ * building it allocates nothing.
+ */
+class node_arena
+{
+public:
+    node_arena() {}
+
+    void *alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (void *p = take(inline_, sizeof(inline_), inline_used_, size, align))
+            return p;
+        if (!chunks_.empty()) {
+            if (void *p = take(chunks_.back().get(), chunk_size_, chunk_used_, size, align))
+                return p;
+        }
+        chunk_size_ = std::max<size_t>(ChunkSize, size + align);
+        chunks_.emplace_back(new char[chunk_size_]);
+        chunk_used_ = 0;
+        return take(chunks_.back().get(), chunk_size_, chunk_used_, size, align);
+    }
+    // value initialized, like new T[n]()
+    template <typename T>
+    T *make(size_t n) {
+        T *p = static_cast<T *>(alloc(sizeof(T) * n, alignof(T)));
+        for (size_t i = 0; i < n; i++)
+            new (p + i) T();
+        return p;
+    }
+    char *dup(QStringView s) {
+        QStringEncoder enc(QStringEncoder::Utf8);
+        char *out = static_cast<char *>(alloc(enc.requiredSpace(s.size()) + 1, 1));
+        char *end = enc.appendToBuffer(out, s);
+        *end = '\0';
+        return out;
+    }
+private:
+    Q_DISABLE_COPY(node_arena)
+    static constexpr size_t InlineSize = 512;
+    static constexpr size_t ChunkSize = 4096;
+
+    static void *take(char *base, size_t cap, size_t &used, size_t size, size_t align) {
+        void *p = base + used;
+        size_t space = cap - used;
+        if (!std::align(align, size, p, space))
+            return nullptr;
+        used = cap - space + size;
+        return p;
+    }
+
+    alignas(std::max_align_t) char inline_[InlineSize];
+    size_t inline_used_ = 0;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    size_t chunk_size_ = 0;
+    size_t chunk_used_ = 0;
+};
+
 struct node_builder {
     explicit node_builder(const QVariant& v)
         : node_() {
         set(&node_, v);
     }
-    ~node_builder() {
-        free_node(&node_);
-    }
     mpv_node *node() { return &node_; }
+    // utf8 copy of s, valid as long as the builder
+    const char *str(QStringView s) { return arena_.dup(s); }
 private:
     Q_DISABLE_COPY(node_builder)
+    node_arena arena_;
     mpv_node node_;
 
     mpv_node_list *create_list(mpv_node *dst, bool is_map, int num) {
         dst->format = is_map ? MPV_FORMAT_NODE_MAP : MPV_FORMAT_NODE_ARRAY;
         try {
-            mpv_node_list *list = new mpv_node_list();
+            mpv_node_list *list = arena_.make<mpv_node_list>(1);
             dst->u.list = list;
-            list->values = new mpv_node[num]();
+            list->values = arena_.make<mpv_node>(num);
             if (is_map)
-                list->keys = new char *[num]();
+                list->keys = arena_.make<char *>(num);
             return list;
         }
         catch (const std::bad_alloc &) {
-            free_node(dst);
+            dst->format = MPV_FORMAT_NONE;
             return nullptr;
         }
     }
-    char *dup_qstring(const QString &s) {
-        QByteArray b = s.toUtf8();
-        char *r = new char[b.size() + 1];
-        std::memcpy(r, b.data(), b.size() + 1);
-        return r;
-    }
     bool test_type(const QVariant &v, QMetaType::Type t) {
-        // The Qt docs say: "Although this function is declared as returning
-        // "QVariant::Type(obsolete), the return value should be interpreted
-        // as QMetaType::Type."
-        // So a cast really seems to be needed to avoid warnings (urgh).
-        return static_cast<int>(v.type()) == static_cast<int>(t);
+        return v.typeId() == static_cast<int>(t);
     }
     void set(mpv_node *dst, const QVariant &src) {
         if (test_type(src, QMetaType::QString)) {
             dst->format = MPV_FORMAT_STRING;
-            dst->u.string = dup_qstring(src.toString());
-            if (!dst->u.string)
-                goto fail;
+            dst->u.string = arena_.dup(src.toString());
         } else if (test_type(src, QMetaType::Bool)) {
             dst->format = MPV_FORMAT_FLAG;
             dst->u.flag = src.toBool() ? 1 : 0;
@@ -136,7 +190,8 @@ private:
             dst->format = MPV_FORMAT_DOUBLE;
             dst->u.double_ = src.toDouble();
         } else if (src.canConvert<QVariantList>()) {
-            QVariantList qlist = src.toList();
+            // shared with src when it already holds a list
+            const QVariantList qlist = src.toList();
             mpv_node_list *list = create_list(dst, false, qlist.size());
             if (!list)
                 goto fail;
@@ -144,18 +199,15 @@ private:
             for (int n = 0; n < qlist.size(); n++)
                 set(&list->values[n], qlist[n]);
         } else if (src.canConvert<QVariantMap>()) {
-            QVariantMap qmap = src.toMap();
+            const QVariantMap qmap = src.toMap();
             mpv_node_list *list = create_list(dst, true, qmap.size());
             if (!list)
                 goto fail;
             list->num = qmap.size();
-            for (int n = 0; n < qmap.size(); n++) {
-                list->keys[n] = dup_qstring(qmap.keys()[n]);
-                if (!list->keys[n]) {
-                    free_node(dst);
-                    goto fail;
-                }
-                set(&list->values[n], qmap.values()[n]);
+            int n = 0;
+            for (auto it = qmap.cbegin(); it != qmap.cend(); ++it, ++n) {
+                list->keys[n] = arena_.dup(it.key());
+                set(&list->values[n], it.value());
             }
         } else {
             goto fail;
@@ -164,31 +216,6 @@ private:
     fail:
         dst->format = MPV_FORMAT_NONE;
     }
-    void free_node(mpv_node *dst) {
-        switch (dst->format) {
-        case MPV_FORMAT_STRING:
-            delete[] dst->u.string;
-            break;
-        case MPV_FORMAT_NODE_ARRAY:
-        case MPV_FORMAT_NODE_MAP: {
-            mpv_node_list *list = dst->u.list;
-            if (list) {
-                for (int n = 0; n < list->num; n++) {
-                    if (list->keys)
-                        delete[] list->keys[n];
-                    if (list->values)
-                        free_node(&list->values[n]);
-                }
-                delete[] list->keys;
-                delete[] list->values;
-            }
-            delete list;
-            break;
-        }
-        default: ;
-        }
-        dst->format = MPV_FORMAT_NONE;
-    }
 };
 
 /**
@@ -210,8 +237,9 @@ struct node_autofree {
  */
 static inline QVariant get_property_variant(mpv_handle *ctx, const QString &name)
 {
+    node_arena names;
     mpv_node node;
-    if (mpv_get_property(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, &node) < 0)
+    if (mpv_get_property(ctx, names.dup(name), MPV_FORMAT_NODE, &node) < 0)
         return QVariant();
     node_autofree f(&node);
     return node_to_variant(&node);
@@ -226,7 +254,7 @@ static inline int set_property_variant(mpv_handle *ctx, const QString &name,
                                        const QVariant &v)
 {
     node_builder node(v);
-    return mpv_set_property(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, node.node());
+    return mpv_set_property(ctx, node.str(name), MPV_FORMAT_NODE, node.node());
 }
 
 /**
@@ -238,7 +266,7 @@ static inline int set_option_variant(mpv_handle *ctx, const QString &name,
                                      const QVariant &v)
 {
     node_builder node(v);
-    return mpv_set_option(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, node.node());
+    return mpv_set_option(ctx, node.str(name), MPV_FORMAT_NODE, node.node());
 }
 
 /**
@@ -305,8 +333,9 @@ static inline bool is_error(const QVariant &v)
  */
 static inline QVariant get_property(mpv_handle *ctx, const QString &name)
 {
+    node_arena names;
     mpv_node node;
-    int err = mpv_get_property(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, &node);
+    int err = mpv_get_property(ctx, names.dup(name), MPV_FORMAT_NODE, &node);
     if (err < 0)
         return QVariant::fromValue(ErrorReturn(err));
     node_autofree f(&node);
@@ -322,7 +351,7 @@ static inline int set_property(mpv_handle *ctx, const QString &name,
                                        const QVariant &v)
 {
     node_builder node(v);
-    return mpv_set_property(ctx, name.toUtf8().data(), MPV_FORMAT_NODE, node.node());
+    return mpv_set_property(ctx, node.str(name), MPV_FORMAT_NODE, node.node());
 }
 
 /**
@@ -342,6 +371,117 @@ static inline QVariant command(mpv_handle *ctx, const QVariant &args)
     return node_to_variant(&res);
 }
 
+/**
+ * mpv_command_node_async() equivalent. The reply comes as MPV_EVENT_COMMAND_REPLY
+ * with reply_userdata set to reply.
+ *
+ * @return mpv error code (<0 on error, >= 0 on success)
+ */
+static inline int command_async(mpv_handle *ctx, uint64_t reply, const QVariant &args)
+{
+    node_builder node(args);
+    return mpv_command_node_async(ctx, reply, node.node());
+}
+
+/**
+ * mpv_set_property_async() equivalent. The reply comes as
+ * MPV_EVENT_SET_PROPERTY_REPLY with reply_userdata set to reply.
+ *
+ * @return mpv error code (<0 on error, >= 0 on success)
+ */
+static inline int set_property_async(mpv_handle *ctx, uint64_t reply, const QString &name,
+                                     const QVariant &v)
+{
+    node_builder node(v);
+    return mpv_set_property_async(ctx, reply, node.str(name), MPV_FORMAT_NODE, node.node());
+}
+
+/**
+ * Native mpv format of a typed property access. These skip mpv_node and
+ * QVariant entirely, for properties read or written often.
+ */
+template <typename T>
+struct format_of;
+template <>
+struct format_of<bool> {
+    static constexpr mpv_format value = MPV_FORMAT_FLAG;
+    using native = int;
+};
+template <>
+struct format_of<int64_t> {
+    static constexpr mpv_format value = MPV_FORMAT_INT64;
+    using native = int64_t;
+};
+template <>
+struct format_of<double> {
+    static constexpr mpv_format value = MPV_FORMAT_DOUBLE;
+    using native = double;
+};
+
+/**
+ * mpv_get_property() with a native format, out is untouched on error.
+ *
+ * @return mpv error code (<0 on error, >= 0 on success)
+ */
+template <typename T>
+static inline int get(mpv_handle *ctx, const char *name, T *out)
+{
+    typename format_of<T>::native v {};
+    int err = mpv_get_property(ctx, name, format_of<T>::value, &v);
+    if (err >= 0)
+        *out = static_cast<T>(v);
+    return err;
+}
+
+/**
+ * mpv_set_property() with a native format.
+ *
+ * @return mpv error code (<0 on error, >= 0 on success)
+ */
+template <typename T>
+static inline int set(mpv_handle *ctx, const char *name, T value)
+{
+    typename format_of<T>::native v = value;
+    return mpv_set_property(ctx, name, format_of<T>::value, &v);
+}
+
+/**
+ * mpv_set_property_async() with a native format, mpv copies the value.
+ *
+ * @return mpv error code (<0 on error, >= 0 on success)
+ */
+template <typename T>
+static inline int set_async(mpv_handle *ctx, uint64_t reply, const char *name, T value)
+{
+    typename format_of<T>::native v = value;
+    return mpv_set_property_async(ctx, reply, name, format_of<T>::value, &v);
+}
+
+/**
+ * String property owned by mpv, freed with mpv_free() when it goes out of scope.
+ */
+class string_ref
+{
+public:
+    explicit string_ref(char *s = nullptr) : s_(s) {}
+    string_ref(string_ref &&o) noexcept : s_(o.s_) { o.s_ = nullptr; }
+    ~string_ref() { mpv_free(s_); }
+    explicit operator bool() const { return s_ != nullptr; }
+    std::string_view view() const { return s_ ? std::string_view(s_) : std::string_view(); }
+    const char *c_str() const { return s_; }
+private:
+    Q_DISABLE_COPY(string_ref)
+    char *s_;
+};
+
+/**
+ * mpv_get_property_string(), empty on error.
+ */
+static inline string_ref get_string(mpv_handle *ctx, const char *name)
+{
+    return string_ref(mpv_get_property_string(ctx, name));
+}
+
 }
 }
 
@@ -4,8 +4,18 @@
 #include "MpvBackend.hpp"
 #include "SceneBackend.hpp"
 #include "MouseGrabber.hpp"
-#include "TTYSwitchMonitor.hpp"
+#include "SessionPolicy.hpp"
 #include "PluginInfo.hpp"
+#include "WallpaperLibrary.hpp"
+#include "FileService.hpp"
+#include "ThumbnailProvider.hpp"
+#include "FrameStats.hpp"
+#include "FrameSnapshot.hpp"
+#include "WindowOcclusion.hpp"
+#include "TraceRecorder.hpp"
+#include "WallpaperIndexModel.hpp"
+#include "WallpaperConfig.hpp"
+#include "QualityGovernor.hpp"
 
 constexpr std::array<uint, 2> WPVer { 1, 2 };
 
@@ -21,7 +31,27 @@ public:
         qmlRegisterType<scenebackend::SceneObject>(uri, WPVer[0], WPVer[1], "SceneViewer");
         std::setlocale(LC_NUMERIC, "C");
         qmlRegisterType<mpv::MpvObject>(uri, WPVer[0], WPVer[1], "Mpv");
-        qmlRegisterType<wekde::TTYSwitchMonitor>(uri, WPVer[0], WPVer[1], "TTYSwitchMonitor");
+        qmlRegisterType<wekde::SessionPolicy>(uri, WPVer[0], WPVer[1], "SessionPolicy");
+        qmlRegisterType<wekde::WallpaperLibrary>(uri, WPVer[0], WPVer[1], "WallpaperLibrary");
+        qmlRegisterType<wekde::FrameStats>(uri, WPVer[0], WPVer[1], "FrameStats");
+        qmlRegisterType<wekde::FrameSnapshot>(uri, WPVer[0], WPVer[1], "FrameSnapshot");
+        qmlRegisterType<wekde::WindowOcclusion>(uri, WPVer[0], WPVer[1], "WindowOcclusion");
+        qmlRegisterType<wekde::TraceRecorder>(uri, WPVer[0], WPVer[1], "TraceRecorder");
+        qmlRegisterType<wekde::WallpaperIndexModel>(uri, WPVer[0], WPVer[1], "WallpaperIndexModel");
+        qmlRegisterType<wekde::QualityGovernor>(uri, WPVer[0], WPVer[1], "QualityGovernor");
+        qmlRegisterSingletonType<wekde::FileService>(
+            uri, WPVer[0], WPVer[1], "FileService", [](QQmlEngine*, QJSEngine*) -> QObject* {
+                return new wekde::FileService();
+            });
+        qmlRegisterSingletonType<wekde::WallpaperConfig>(
+            uri, WPVer[0], WPVer[1], "WallpaperConfig", [](QQmlEngine*, QJSEngine*) -> QObject* {
+                return new wekde::WallpaperConfig();
+            });
+    }
+    void initializeEngine(QQmlEngine* engine, const char* uri) override {
+        if (strcmp(uri, "com.github.catsout.wallpaperEngineKde") != 0) return;
+        if (! engine->imageProvider(wekde::ThumbnailProvider::Name))
+            engine->addImageProvider(wekde::ThumbnailProvider::Name, new wekde::ThumbnailProvider);
     }
 };
 